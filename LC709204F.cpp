@@ -6,14 +6,217 @@
  * @copyright MIT (see license.txt)
  */
 
-#include "Arduino.h"
+#include <stddef.h>
+#include <string.h>
 #include "LC709204F.h"
 
+#if LC709204F_CRC8_STRATEGY == LC709204F_CRC8_TABLE
+/**
+ * CRC8 lookup table (polynomial 0x07), one entry per input byte value.
+ */
+static const uint8_t LC709204F_CRC8_TABLE_DATA[256] PROGMEM = {
+    0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15, 0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D,
+    0x70, 0x77, 0x7E, 0x79, 0x6C, 0x6B, 0x62, 0x65, 0x48, 0x4F, 0x46, 0x41, 0x54, 0x53, 0x5A, 0x5D,
+    0xE0, 0xE7, 0xEE, 0xE9, 0xFC, 0xFB, 0xF2, 0xF5, 0xD8, 0xDF, 0xD6, 0xD1, 0xC4, 0xC3, 0xCA, 0xCD,
+    0x90, 0x97, 0x9E, 0x99, 0x8C, 0x8B, 0x82, 0x85, 0xA8, 0xAF, 0xA6, 0xA1, 0xB4, 0xB3, 0xBA, 0xBD,
+    0xC7, 0xC0, 0xC9, 0xCE, 0xDB, 0xDC, 0xD5, 0xD2, 0xFF, 0xF8, 0xF1, 0xF6, 0xE3, 0xE4, 0xED, 0xEA,
+    0xB7, 0xB0, 0xB9, 0xBE, 0xAB, 0xAC, 0xA5, 0xA2, 0x8F, 0x88, 0x81, 0x86, 0x93, 0x94, 0x9D, 0x9A,
+    0x27, 0x20, 0x29, 0x2E, 0x3B, 0x3C, 0x35, 0x32, 0x1F, 0x18, 0x11, 0x16, 0x03, 0x04, 0x0D, 0x0A,
+    0x57, 0x50, 0x59, 0x5E, 0x4B, 0x4C, 0x45, 0x42, 0x6F, 0x68, 0x61, 0x66, 0x73, 0x74, 0x7D, 0x7A,
+    0x89, 0x8E, 0x87, 0x80, 0x95, 0x92, 0x9B, 0x9C, 0xB1, 0xB6, 0xBF, 0xB8, 0xAD, 0xAA, 0xA3, 0xA4,
+    0xF9, 0xFE, 0xF7, 0xF0, 0xE5, 0xE2, 0xEB, 0xEC, 0xC1, 0xC6, 0xCF, 0xC8, 0xDD, 0xDA, 0xD3, 0xD4,
+    0x69, 0x6E, 0x67, 0x60, 0x75, 0x72, 0x7B, 0x7C, 0x51, 0x56, 0x5F, 0x58, 0x4D, 0x4A, 0x43, 0x44,
+    0x19, 0x1E, 0x17, 0x10, 0x05, 0x02, 0x0B, 0x0C, 0x21, 0x26, 0x2F, 0x28, 0x3D, 0x3A, 0x33, 0x34,
+    0x4E, 0x49, 0x40, 0x47, 0x52, 0x55, 0x5C, 0x5B, 0x76, 0x71, 0x78, 0x7F, 0x6A, 0x6D, 0x64, 0x63,
+    0x3E, 0x39, 0x30, 0x37, 0x22, 0x25, 0x2C, 0x2B, 0x06, 0x01, 0x08, 0x0F, 0x1A, 0x1D, 0x14, 0x13,
+    0xAE, 0xA9, 0xA0, 0xA7, 0xB2, 0xB5, 0xBC, 0xBB, 0x96, 0x91, 0x98, 0x9F, 0x8A, 0x8D, 0x84, 0x83,
+    0xDE, 0xD9, 0xD0, 0xD7, 0xC2, 0xC5, 0xCC, 0xCB, 0xE6, 0xE1, 0xE8, 0xEF, 0xFA, 0xFD, 0xF4, 0xF3,
+};
+#elif LC709204F_CRC8_STRATEGY == LC709204F_CRC8_NIBBLE
+/**
+ * CRC8 lookup table (polynomial 0x07), one entry per input nibble value.
+ */
+static const uint8_t LC709204F_CRC8_NIBBLE_DATA[16] PROGMEM = {
+    0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15, 0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D,
+};
+#endif
+
+/**
+ * CRC8 single byte update.
+ *
+ * @param crc The current CRC8 value.
+ * @param data The byte to feed into the CRC8.
+ *
+ * @return Updated CRC8 value.
+ */
+static inline uint8_t crc8Update(uint8_t crc, uint8_t data) {
+    crc ^= data;
+#if LC709204F_CRC8_STRATEGY == LC709204F_CRC8_TABLE
+    return pgm_read_byte(&LC709204F_CRC8_TABLE_DATA[crc]);
+#elif LC709204F_CRC8_STRATEGY == LC709204F_CRC8_NIBBLE
+    crc = (crc << 4) ^ pgm_read_byte(&LC709204F_CRC8_NIBBLE_DATA[crc >> 4]);
+    return (crc << 4) ^ pgm_read_byte(&LC709204F_CRC8_NIBBLE_DATA[crc >> 4]);
+#else
+    const uint8_t POLYNOMIAL(0x07);
+
+    for (int i = 8; i; --i) {
+        crc = (crc & 0x80) ? (crc << 1) ^ POLYNOMIAL : (crc << 1);
+    }
+    return crc;
+#endif
+}
+
+/**
+ * Compile-time CRC8 byte update, used to build the prefix tables below.
+ */
+static constexpr uint8_t crc8Shift(uint8_t crc, int bits) {
+    return bits ? crc8Shift((crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1), bits - 1) : crc;
+}
+
+static constexpr uint8_t crc8Const(uint8_t crc, uint8_t data) {
+    return crc8Shift(crc ^ data, 8);
+}
+
+/**
+ * CRC8 state after the fixed part of a readWord transfer:
+ * write address, command, read address.
+ */
+static constexpr uint8_t crc8ReadPrefix(uint8_t command) {
+    return crc8Const(crc8Const(crc8Const(0x00, LC709204F_I2CADDR * 2), command), LC709204F_I2CADDR * 2 | 0x1);
+}
+
+/**
+ * CRC8 state after the fixed part of a writeWord transfer:
+ * write address, command.
+ */
+static constexpr uint8_t crc8WritePrefix(uint8_t command) {
+    return crc8Const(crc8Const(0x00, LC709204F_I2CADDR * 2), command);
+}
+
+#define LC709204F_CRC8_PREFIX_ROW(fn, base) \
+    fn(base + 0), fn(base + 1), fn(base + 2), fn(base + 3), fn(base + 4), fn(base + 5), fn(base + 6), fn(base + 7)
+
+/**
+ * Prefix CRC8 states for every command from 0x00 up to the last LC709204F_REG_* register,
+ * computed at compile time for the default i2c address.
+ */
+static const uint8_t LC709204F_CRC8_READ_PREFIX[] PROGMEM = {
+    LC709204F_CRC8_PREFIX_ROW(crc8ReadPrefix, 0x00),
+    LC709204F_CRC8_PREFIX_ROW(crc8ReadPrefix, 0x08),
+    LC709204F_CRC8_PREFIX_ROW(crc8ReadPrefix, 0x10),
+    LC709204F_CRC8_PREFIX_ROW(crc8ReadPrefix, 0x18),
+    LC709204F_CRC8_PREFIX_ROW(crc8ReadPrefix, 0x20),
+    LC709204F_CRC8_PREFIX_ROW(crc8ReadPrefix, 0x28),
+    LC709204F_CRC8_PREFIX_ROW(crc8ReadPrefix, 0x30),
+};
+
+static const uint8_t LC709204F_CRC8_WRITE_PREFIX[] PROGMEM = {
+    LC709204F_CRC8_PREFIX_ROW(crc8WritePrefix, 0x00),
+    LC709204F_CRC8_PREFIX_ROW(crc8WritePrefix, 0x08),
+    LC709204F_CRC8_PREFIX_ROW(crc8WritePrefix, 0x10),
+    LC709204F_CRC8_PREFIX_ROW(crc8WritePrefix, 0x18),
+    LC709204F_CRC8_PREFIX_ROW(crc8WritePrefix, 0x20),
+    LC709204F_CRC8_PREFIX_ROW(crc8WritePrefix, 0x28),
+    LC709204F_CRC8_PREFIX_ROW(crc8WritePrefix, 0x30),
+};
+
+static_assert(sizeof(LC709204F_CRC8_READ_PREFIX) >= LC709204F_REG_COUNT, "CRC8 prefix table does not cover all registers");
+static_assert(sizeof(LC709204F_CRC8_WRITE_PREFIX) >= LC709204F_REG_COUNT, "CRC8 prefix table does not cover all registers");
+
+/**
+ * Shadow register file slot of a command.
+ *
+ * Only the R/W configuration registers, which the LC709204F never changes on its own,
+ * are shadowed.
+ *
+ * @param command The I2C register/command
+ * @return Slot index, or -1 if the register is not shadowed
+ */
+static int8_t shadowSlot(uint8_t command) {
+    switch (command) {
+        case LC709204F_REG_TSENSE1_THERMISTOR_B:
+            return 0;
+        case LC709204F_REG_CURRENT_DIRECTION:
+            return 1;
+        case LC709204F_REG_APA:
+            return 2;
+        case LC709204F_REG_APT:
+            return 3;
+        case LC709204F_REG_TSENSE2_THERMISTOR_B:
+            return 4;
+        case LC709204F_REG_CHANGE_OF_THE_PARAMETER:
+            return 5;
+        case LC709204F_REG_ALARM_LOW_RSOC:
+            return 6;
+        case LC709204F_REG_ALARM_LOW_CELL_VOLTAGE:
+            return 7;
+        case LC709204F_REG_IC_POWER_MODE:
+            return 8;
+        case LC709204F_REG_STATUS_BIT:
+            return 9;
+        case LC709204F_REG_TERMINATION_CURRENT_RATE:
+            return 10;
+        case LC709204F_REG_EMPTY_CELL_VOLTAGE:
+            return 11;
+        case LC709204F_REG_ITE_OFFSET:
+            return 12;
+        case LC709204F_REG_ALARM_HIGH_CELL_VOLTAGE:
+            return 13;
+        case LC709204F_REG_ALARM_LOW_TEMPERATURE:
+            return 14;
+        case LC709204F_REG_ALARM_HIGH_TEMPERATURE:
+            return 15;
+        default:
+            return -1;
+    }
+}
+
+/**
+ * Shadowed registers, in slot order.
+ */
+static const uint8_t LC709204F_SHADOW_REGISTERS[LC709204F_SHADOW_SIZE] = {
+    LC709204F_REG_TSENSE1_THERMISTOR_B,
+    LC709204F_REG_CURRENT_DIRECTION,
+    LC709204F_REG_APA,
+    LC709204F_REG_APT,
+    LC709204F_REG_TSENSE2_THERMISTOR_B,
+    LC709204F_REG_CHANGE_OF_THE_PARAMETER,
+    LC709204F_REG_ALARM_LOW_RSOC,
+    LC709204F_REG_ALARM_LOW_CELL_VOLTAGE,
+    LC709204F_REG_IC_POWER_MODE,
+    LC709204F_REG_STATUS_BIT,
+    LC709204F_REG_TERMINATION_CURRENT_RATE,
+    LC709204F_REG_EMPTY_CELL_VOLTAGE,
+    LC709204F_REG_ITE_OFFSET,
+    LC709204F_REG_ALARM_HIGH_CELL_VOLTAGE,
+    LC709204F_REG_ALARM_LOW_TEMPERATURE,
+    LC709204F_REG_ALARM_HIGH_TEMPERATURE,
+};
+
+/**
+ * Rounds a temperature in °C to the nearest 0.1°C.
+ */
+static int16_t roundDeciCelsius(float temperature) {
+    return (int16_t)(temperature * 10 + (temperature < 0 ? -0.5f : 0.5f));
+}
+
 /**
  * LC709204F class
  */
-LC709204F::LC709204F(TwoWire *theWire) {
-    _wire = theWire;
+LC709204F::LC709204F(LC709204F_BUS *theWire, uint8_t address) : _transport(theWire) {
+    _lastStatus = LC709204F_STATUS_OK;
+    _shadowEnabled = false;
+    _shadowValid = 0;
+    _writeElision = true;
+    _readsIssued = 0;
+    _writesIssued = 0;
+    _writesElided = 0;
+    _requestSequence = 0;
+    for (uint8_t i = 0; i < LC709204F_ASYNC_QUEUE_SIZE; i++) {
+        _requests[i].state = LC709204F_REQUEST_FREE;
+    }
+    LC709204F_STAT(resetStats());
+    setAddress(address);
 }
 
 LC709204F::~LC709204F(void) {}
@@ -25,8 +228,8 @@ LC709204F::~LC709204F(void) {}
  * @return True if initialization was successful, otherwise false.
  */
 
-bool LC709204F::init(lc709204f_apa_adjustment_t APAAdjustment, lc709204f_battery_profile_t batteryProfile, TwoWire *wire) {
-    _wire->begin();
+bool LC709204F::init(lc709204f_apa_adjustment_t APAAdjustment, lc709204f_battery_profile_t batteryProfile, LC709204F_BUS *wire) {
+    _transport.begin();
 
     if (!setAPA(APAAdjustment))
         return false;
@@ -43,6 +246,67 @@ bool LC709204F::init(lc709204f_apa_adjustment_t APAAdjustment, lc709204f_battery
     return true;
 }
 
+/**
+ * LC709204F warm start initialization.
+ *
+ * For MCUs that reboot often (eg: deep sleep) while the LC709204F stays powered and configured.
+ * BatteryStatus is read first: if the power on reset bit is clear, APA, battery profile and power
+ * mode are read as a fingerprint of a previous init(), and when they match nothing is written.
+ * Otherwise (power on reset, other configuration, read error) a full init() is done.
+ *
+ * @param APAAdjustment Expected / configured APA
+ * @param batteryProfile Expected / configured battery profile
+ * @param warm Optional, set to true if the LC709204F was already initialized and init() was skipped
+ * @return True if the LC709204F is initialized
+ */
+bool LC709204F::warmInit(lc709204f_apa_adjustment_t APAAdjustment, lc709204f_battery_profile_t batteryProfile, bool *warm) {
+    uint16_t val;
+    bool configured = false;
+
+    _transport.begin();
+
+    if (readWord(LC709204F_REG_BATTERY_STATUS, &val) && !(val & LC709204F_BATTERY_STATUS_INITIALIZED)) {
+        configured = readWord(LC709204F_REG_APA, &val) && val == APAAdjustment &&
+                     readWord(LC709204F_REG_CHANGE_OF_THE_PARAMETER, &val) && val == batteryProfile &&
+                     readWord(LC709204F_REG_IC_POWER_MODE, &val) && val == LC709204F_POWER_MODE_OPERATE;
+    }
+
+    if (warm != NULL)
+        *warm = configured;
+
+    return configured || init(APAAdjustment, batteryProfile);
+}
+
+/**
+ * Set the i2c address of the LC709204F.
+ *
+ * The CRC8 prefix tables are built for LC709204F_I2CADDR. CRC8 is linear, so for
+ * any other address the prefix only needs to be XORed with a per-address constant,
+ * which is computed here once.
+ *
+ * @param address 7-bit i2c address
+ */
+void LC709204F::setAddress(uint8_t address) {
+    uint8_t prefix[3];
+
+    _address = address;
+
+    prefix[0] = address * 2;
+    prefix[1] = 0x00;
+    prefix[2] = prefix[0] | 0x1;
+    _crcReadAdjust = crc8(prefix, 3) ^ pgm_read_byte(&LC709204F_CRC8_READ_PREFIX[0x00]);
+    _crcWriteAdjust = crc8(prefix, 2) ^ pgm_read_byte(&LC709204F_CRC8_WRITE_PREFIX[0x00]);
+}
+
+/**
+ * Get the i2c address of the LC709204F.
+ *
+ * @return 7-bit i2c address
+ */
+uint8_t LC709204F::getAddress(void) {
+    return _address;
+}
+
 /**
  * Get TimeToEmpty (0x03)
  *
@@ -162,9 +426,21 @@ uint16_t LC709204F::getCellTemperatureTSENSE1(void) {
  * @return Floating point value from -30°C to 80°C
  */
 float LC709204F::getCellTemperature(void) {
-    uint16_t temp = getCellTemperatureTSENSE1();
-    float temperature = map(temp, 0x980, 0xDCC, -300, 800);
-    return temperature / 10.0;
+    return getCellTemperatureDeciC() / 10.0f;
+}
+
+/**
+ * Get CellTemperature (0x08)
+ *
+ * Displays Cell Temperature in 0.1°C, without floating point math.
+ * Range: -300 to 800 (-30°C to 80°C)
+ * Unit: 0.1°C
+ * Initial value: 250 (25°C)
+ *
+ * @return Value from -300 to 800
+ */
+int16_t LC709204F::getCellTemperatureDeciC(void) {
+    return toDeciCelsius(getCellTemperatureTSENSE1());
 }
 
 /**
@@ -194,9 +470,22 @@ bool LC709204F::setCellTemperatureTSENSE1(uint16_t b) {
  * @return True on successful I2C write
  */
 bool LC709204F::setCellTemperature(float temperature) {
-    uint16_t intTemp = (uint16_t)(temperature * 10);
-    uint16_t temp = map(intTemp, -300, 800, 0x980, 0xDCC);
-    return writeWord(LC709204F_REG_CELL_TEMPERATURE_TSENSE1, temp);
+    return setCellTemperatureDeciC(roundDeciCelsius(temperature));
+}
+
+/**
+ * Set CellTemperature(0x08)
+ *
+ * Sets Cell Temperature in 0.1°C when working in I2C mode.
+ * Range: -300 to 800 (-30°C to 80°C)
+ * Unit: 0.1°C
+ * Initial value: 250 (25°C)
+ *
+ * @param deciCelsius The value to set it to
+ * @return True on successful I2C write
+ */
+bool LC709204F::setCellTemperatureDeciC(int16_t deciCelsius) {
+    return writeWord(LC709204F_REG_CELL_TEMPERATURE_TSENSE1, fromDeciCelsius(deciCelsius));
 }
 
 /**
@@ -246,7 +535,7 @@ uint16_t LC709204F::getCurrentDirection(void) {
  * @return True on I2C command success
  */
 bool LC709204F::setCurrentDirection(lc709204f_current_direction_t currentDirection) {
-    return writeWord(LC709204F_REG_BEFORE_RSOC, currentDirection);
+    return writeWord(LC709204F_REG_CURRENT_DIRECTION, currentDirection);
 }
 
 /**
@@ -785,10 +1074,7 @@ bool LC709204F::setAlarmHighCellVoltage(uint16_t b) {
  * @return float value read from LC709204F_REG_ALARM_LOW_TEMPERATURE register
  */
 float LC709204F::getAlarmLowTemperature(void) {
-    uint16_t temp = 0;
-    readWord(LC709204F_REG_ALARM_LOW_TEMPERATURE, &temp);
-    float temperature = map(temp, 0x980, 0xDCC, -300, 800);
-    return temperature / 10.0;
+    return getAlarmLowTemperatureDeciC() / 10.0f;
 }
 
 /**
@@ -805,9 +1091,40 @@ float LC709204F::getAlarmLowTemperature(void) {
  * @return True on I2C command success
  */
 bool LC709204F::setAlarmLowTemperature(float temp) {
-    uint16_t intTemp = (uint16_t)(temp * 10);
-    uint16_t temperature = map(intTemp, -300, 800, 0x980, 0xDCC);
-    return writeWord(LC709204F_REG_ALARM_LOW_TEMPERATURE, temperature);
+    return setAlarmLowTemperatureDeciC(roundDeciCelsius(temp));
+}
+
+/**
+ * Get AlarmLowTemperature (0x20)
+ *
+ * Gets the Low Temperature alarm threshold in 0.1°C.
+ * Range:
+ * - -2732: Disable (register value 0x0000)
+ * - -300 to 800 (-30°C to 80°C)
+ * Unit: 0.1°C
+ *
+ * @return Value read from LC709204F_REG_ALARM_LOW_TEMPERATURE register, in 0.1°C
+ */
+int16_t LC709204F::getAlarmLowTemperatureDeciC(void) {
+    uint16_t temp = 0;
+    readWord(LC709204F_REG_ALARM_LOW_TEMPERATURE, &temp);
+    return toDeciCelsius(temp);
+}
+
+/**
+ * Set AlarmLowTemperature (0x20)
+ *
+ * Sets the Low Temperature alarm threshold in 0.1°C.
+ * Range:
+ * - -2732: Disable (register value 0x0000)
+ * - -300 to 800 (-30°C to 80°C)
+ * Unit: 0.1°C
+ *
+ * @param deciCelsius Value to write to LC709204F_REG_ALARM_LOW_TEMPERATURE register, in 0.1°C
+ * @return True on I2C command success
+ */
+bool LC709204F::setAlarmLowTemperatureDeciC(int16_t deciCelsius) {
+    return writeWord(LC709204F_REG_ALARM_LOW_TEMPERATURE, fromDeciCelsius(deciCelsius));
 }
 
 /**
@@ -823,10 +1140,7 @@ bool LC709204F::setAlarmLowTemperature(float temp) {
  * @return float value read from LC709204F_REG_ALARM_HIGH_TEMPERATURE register
  */
 float LC709204F::getAlarmHighTemperature(void) {
-    uint16_t temp = 0;
-    readWord(LC709204F_REG_ALARM_HIGH_TEMPERATURE, &temp);
-    float temperature = map(temp, 0x980, 0xDCC, -300, 800);
-    return temperature / 10.0;
+    return getAlarmHighTemperatureDeciC() / 10.0f;
 }
 
 /**
@@ -843,9 +1157,40 @@ float LC709204F::getAlarmHighTemperature(void) {
  * @return True on I2C command success
  */
 bool LC709204F::setAlarmHighTemperature(float temp) {
-    uint16_t intTemp = (uint16_t)(temp * 10);
-    uint16_t temperature = map(intTemp, -300, 800, 0x980, 0xDCC);
-    return writeWord(LC709204F_REG_ALARM_HIGH_TEMPERATURE, temperature);
+    return setAlarmHighTemperatureDeciC(roundDeciCelsius(temp));
+}
+
+/**
+ * Get AlarmHighTemperature (0x21)
+ *
+ * Gets the High Temperature alarm threshold in 0.1°C.
+ * Range:
+ * - -2732: Disable (register value 0x0000)
+ * - -300 to 800 (-30°C to 80°C)
+ * Unit: 0.1°C
+ *
+ * @return Value read from LC709204F_REG_ALARM_HIGH_TEMPERATURE register, in 0.1°C
+ */
+int16_t LC709204F::getAlarmHighTemperatureDeciC(void) {
+    uint16_t temp = 0;
+    readWord(LC709204F_REG_ALARM_HIGH_TEMPERATURE, &temp);
+    return toDeciCelsius(temp);
+}
+
+/**
+ * Set AlarmHighTemperature (0x21)
+ *
+ * Sets the High Temperature alarm threshold in 0.1°C.
+ * Range:
+ * - -2732: Disable (register value 0x0000)
+ * - -300 to 800 (-30°C to 80°C)
+ * Unit: 0.1°C
+ *
+ * @param deciCelsius Value to write to LC709204F_REG_ALARM_HIGH_TEMPERATURE register, in 0.1°C
+ * @return True on I2C command success
+ */
+bool LC709204F::setAlarmHighTemperatureDeciC(int16_t deciCelsius) {
+    return writeWord(LC709204F_REG_ALARM_HIGH_TEMPERATURE, fromDeciCelsius(deciCelsius));
 }
 
 /**
@@ -861,11 +1206,9 @@ bool LC709204F::setAlarmHighTemperature(float temp) {
  * @return 32-bit value read from LC709204F_REG_TOTAL_RUN_TIME_LOWER_16BIT and LC709204F_REG_TOTAL_RUN_TIME_HIGHER_8BIT registers
  */
 uint32_t LC709204F::getTotalRunTime(void) {
-    uint16_t lower = 0;
-    uint16_t higher = 0;
-    readWord(LC709204F_REG_TOTAL_RUN_TIME_LOWER_16BIT, &lower);
-    readWord(LC709204F_REG_TOTAL_RUN_TIME_HIGHER_8BIT, &higher);
-    return higher * 0x10000 + lower;
+    uint32_t val = 0;
+    readDoubleWord(LC709204F_REG_TOTAL_RUN_TIME_LOWER_16BIT, LC709204F_REG_TOTAL_RUN_TIME_HIGHER_8BIT, &val);
+    return val;
 }
 
 /**
@@ -901,11 +1244,9 @@ bool LC709204F::setTotalRunTime(uint32_t b) {
  * @return 32-bit value read from LC709204F_REG_ACCUMULATED_TEMPERATURE_LOWER_16BIT and LC709204F_REG_ACCUMULATED_TEMPERATURE_HIGHER_16BIT registers
  */
 uint32_t LC709204F::getAccumulatedTemperature(void) {
-    uint16_t lower = 0;
-    uint16_t higher = 0;
-    readWord(LC709204F_REG_ACCUMULATED_TEMPERATURE_LOWER_16BIT, &lower);
-    readWord(LC709204F_REG_ACCUMULATED_TEMPERATURE_HIGHER_16BIT, &higher);
-    return higher * 0x10000 + lower;
+    uint32_t val = 0;
+    readDoubleWord(LC709204F_REG_ACCUMULATED_TEMPERATURE_LOWER_16BIT, LC709204F_REG_ACCUMULATED_TEMPERATURE_HIGHER_16BIT, &val);
+    return val;
 }
 
 /**
@@ -941,11 +1282,9 @@ bool LC709204F::setAccumulatedTemperature(uint32_t b) {
  * @return 32-bit value read from LC709204F_REG_ACCUMULATED_RSOC_LOWER_16BIT and LC709204F_REG_ACCUMULATED_RSOC_HIGHER_16BIT registers
  */
 uint32_t LC709204F::getAccumulatedRSOC(void) {
-    uint16_t lower = 0;
-    uint16_t higher = 0;
-    readWord(LC709204F_REG_ACCUMULATED_RSOC_LOWER_16BIT, &lower);
-    readWord(LC709204F_REG_ACCUMULATED_RSOC_HIGHER_16BIT, &higher);
-    return higher * 0x10000 + lower;
+    uint32_t val = 0;
+    readDoubleWord(LC709204F_REG_ACCUMULATED_RSOC_LOWER_16BIT, LC709204F_REG_ACCUMULATED_RSOC_HIGHER_16BIT, &val);
+    return val;
 }
 
 /**
@@ -1057,9 +1396,21 @@ uint16_t LC709204F::getMaximumCellTemperatureTSENSE1(void) {
  * @return Floating point value from -30°C to 80°C
  */
 float LC709204F::getMaximumCellTemperature(void) {
-    uint16_t temp = getMaximumCellTemperatureTSENSE1();
-    float temperature = map(temp, 0x980, 0xDCC, -300, 800);
-    return temperature / 10.0;
+    return getMaximumCellTemperatureDeciC() / 10.0f;
+}
+
+/**
+ * Get MaximumCellTemperature (0x2C)
+ *
+ * Gets the historical maximum temperature of TSENSE1 in 0.1°C.
+ * Range: -300 to 800 (-30°C to 80°C)
+ * Unit: 0.1°C
+ * Initial value: -300 (-30°C)
+ *
+ * @return Value from -300 to 800
+ */
+int16_t LC709204F::getMaximumCellTemperatureDeciC(void) {
+    return toDeciCelsius(getMaximumCellTemperatureTSENSE1());
 }
 
 /**
@@ -1089,9 +1440,22 @@ bool LC709204F::setMaximumCellTemperatureTSENSE1(uint16_t b) {
  * @return True on successful I2C write
  */
 bool LC709204F::setMaximumCellTemperature(float temperature) {
-    uint16_t intTemp = (uint16_t)(temperature * 10);
-    uint16_t temp = map(intTemp, -300, 800, 0x980, 0xDCC);
-    return writeWord(LC709204F_REG_MAXIMUM_CELL_TEMPERATURE_TSENSE1, temp);
+    return setMaximumCellTemperatureDeciC(roundDeciCelsius(temperature));
+}
+
+/**
+ * Set MaximumCellTemperature (0x2C)
+ *
+ * Sets the historical maximum temperature of TSENSE1 in 0.1°C.
+ * Range: -300 to 800 (-30°C to 80°C)
+ * Unit: 0.1°C
+ * Initial value: -300 (-30°C)
+ *
+ * @param deciCelsius The value to set it to
+ * @return True on successful I2C write
+ */
+bool LC709204F::setMaximumCellTemperatureDeciC(int16_t deciCelsius) {
+    return writeWord(LC709204F_REG_MAXIMUM_CELL_TEMPERATURE_TSENSE1, fromDeciCelsius(deciCelsius));
 }
 
 /**
@@ -1121,9 +1485,21 @@ uint16_t LC709204F::getMinimumCellTemperatureTSENSE1(void) {
  * @return Floating point value from -30°C to 80°C
  */
 float LC709204F::getMinimumCellTemperature(void) {
-    uint16_t temp = getMinimumCellTemperatureTSENSE1();
-    float temperature = map(temp, 0x980, 0xDCC, -300, 800);
-    return temperature / 10.0;
+    return getMinimumCellTemperatureDeciC() / 10.0f;
+}
+
+/**
+ * Get MinimumCellTemperature (0x2D)
+ *
+ * Gets the historical minimum temperature of TSENSE1 in 0.1°C.
+ * Range: -300 to 800 (-30°C to 80°C)
+ * Unit: 0.1°C
+ * Initial value: 800 (80°C)
+ *
+ * @return Value from -300 to 800
+ */
+int16_t LC709204F::getMinimumCellTemperatureDeciC(void) {
+    return toDeciCelsius(getMinimumCellTemperatureTSENSE1());
 }
 
 /**
@@ -1153,9 +1529,22 @@ bool LC709204F::setMinimumCellTemperatureTSENSE1(uint16_t b) {
  * @return True on successful I2C write
  */
 bool LC709204F::setMinimumCellTemperature(float temperature) {
-    uint16_t intTemp = (uint16_t)(temperature * 10);
-    uint16_t temp = map(intTemp, -300, 800, 0x980, 0xDCC);
-    return writeWord(LC709204F_REG_MINIMUM_CELL_TEMPERATURE_TSENSE1, temp);
+    return setMinimumCellTemperatureDeciC(roundDeciCelsius(temperature));
+}
+
+/**
+ * Set MinimumCellTemperature (0x2D)
+ *
+ * Sets the historical minimum temperature of TSENSE1 in 0.1°C.
+ * Range: -300 to 800 (-30°C to 80°C)
+ * Unit: 0.1°C
+ * Initial value: 800 (80°C)
+ *
+ * @param deciCelsius The value to set it to
+ * @return True on successful I2C write
+ */
+bool LC709204F::setMinimumCellTemperatureDeciC(int16_t deciCelsius) {
+    return writeWord(LC709204F_REG_MINIMUM_CELL_TEMPERATURE_TSENSE1, fromDeciCelsius(deciCelsius));
 }
 
 /**
@@ -1185,9 +1574,48 @@ uint16_t LC709204F::getAmbientTemperatureTSENSE2(void) {
  * @return Floating point value from -30°C to 80°C
  */
 float LC709204F::getAmbientTemperature(void) {
-    uint16_t temp = getAmbientTemperatureTSENSE2();
-    float temperature = map(temp, 0x980, 0xDCC, -300, 800);
-    return temperature / 10.0;
+    return getAmbientTemperatureDeciC() / 10.0f;
+}
+
+/**
+ * Get AmbientTemperature (0x30)
+ *
+ * Gets the ambient temperature of TSENSE2 in 0.1°C.
+ * Range: -300 to 800 (-30°C to 80°C)
+ * Unit: 0.1°C
+ * Initial value: 250 (25°C)
+ *
+ * @return Value from -300 to 800
+ */
+int16_t LC709204F::getAmbientTemperatureDeciC(void) {
+    return toDeciCelsius(getAmbientTemperatureTSENSE2());
+}
+
+/**
+ * Read Temperatures (0x08, 0x30)
+ *
+ * Reads the cell (TSENSE1) and ambient (TSENSE2) temperatures in 0.1°C.
+ *
+ * @param cell Pointer to store the cell temperature, or NULL to skip it
+ * @param ambient Pointer to store the ambient temperature, or NULL to skip it
+ * @return True if all requested temperatures were read
+ */
+bool LC709204F::readTemperaturesDeciC(int16_t *cell, int16_t *ambient) {
+    uint16_t temp;
+
+    if (cell != NULL) {
+        if (!readWord(LC709204F_REG_CELL_TEMPERATURE_TSENSE1, &temp))
+            return false;
+        *cell = toDeciCelsius(temp);
+    }
+
+    if (ambient != NULL) {
+        if (!readWord(LC709204F_REG_AMBIENT_TEMPERATURE_TSENSE2, &temp))
+            return false;
+        *ambient = toDeciCelsius(temp);
+    }
+
+    return true;
 }
 
 /**
@@ -1217,127 +1645,924 @@ uint16_t LC709204F::getStateOfHealth(void) {
 * @return 32-bit value read from LC709204F_REG_USER_ID_LOWER_16BIT and LC709204F_REG_USER_ID_HIGHER_16BIT registers
 */
 uint32_t LC709204F::getUserId(void) {
-    uint16_t lower = 0;
-    uint16_t higher = 0;
-    readWord(LC709204F_REG_USER_ID_LOWER_16BIT, &lower);
-    readWord(LC709204F_REG_USER_ID_HIGHER_16BIT, &higher);
-    return higher * 0x10000 + lower;
+    uint32_t val = 0;
+    // Not a counter, never carries
+    readDoubleWord(LC709204F_REG_USER_ID_LOWER_16BIT, LC709204F_REG_USER_ID_HIGHER_16BIT, &val, 0);
+    return val;
 }
 
 /**
- * readWord
+ * Register and position in lc709204f_battery_snapshot_t of each snapshot field,
+ * in lc709204f_snapshot_field_t bit order.
+ */
+static const struct {
+    uint8_t command;
+    uint8_t offset;
+} LC709204F_SNAPSHOT_FIELDS[] = {
+    {LC709204F_REG_CELL_VOLTAGE, offsetof(lc709204f_battery_snapshot_t, cellVoltage)},
+    {LC709204F_REG_RSOC, offsetof(lc709204f_battery_snapshot_t, rsoc)},
+    {LC709204F_REG_ITE, offsetof(lc709204f_battery_snapshot_t, ite)},
+    {LC709204F_REG_TIME_TO_EMPTY, offsetof(lc709204f_battery_snapshot_t, timeToEmpty)},
+    {LC709204F_REG_TIME_TO_FULL, offsetof(lc709204f_battery_snapshot_t, timeToFull)},
+    {LC709204F_REG_CELL_TEMPERATURE_TSENSE1, offsetof(lc709204f_battery_snapshot_t, cellTemperature)},
+    {LC709204F_REG_AMBIENT_TEMPERATURE_TSENSE2, offsetof(lc709204f_battery_snapshot_t, ambientTemperature)},
+    {LC709204F_REG_BATTERY_STATUS, offsetof(lc709204f_battery_snapshot_t, batteryStatus)},
+    {LC709204F_REG_CYCLE_COUNT, offsetof(lc709204f_battery_snapshot_t, cycleCount)},
+    {LC709204F_REG_STATE_OF_HEALTH, offsetof(lc709204f_battery_snapshot_t, stateOfHealth)},
+};
+
+/**
+ * Read Snapshot
+ *
+ * Reads the requested telemetry registers in one pass and stores the raw register values.
+ * Fields that could not be read keep their previous value and have their bit cleared in
+ * snapshot.valid, so a failed read can be told apart from a zero reading.
+ *
+ * @param snapshot Snapshot to fill
+ * @param fields Mask of lc709204f_snapshot_field_t values to read (default LC709204F_FIELD_ALL)
+ * @return True if every requested field was read successfully
+ */
+bool LC709204F::readSnapshot(lc709204f_battery_snapshot_t &snapshot, uint16_t fields) {
+    const uint8_t count = sizeof(LC709204F_SNAPSHOT_FIELDS) / sizeof(LC709204F_SNAPSHOT_FIELDS[0]);
+    uint8_t *base = (uint8_t *) &snapshot;
+    lc709204f_batch_item_t items[count];
+    uint8_t index[count];
+    uint8_t n = 0;
+
+    fields &= LC709204F_FIELD_ALL;
+    snapshot.valid = 0;
+
+    for (uint8_t i = 0; fields >> i; i++) {
+        if (fields & (1 << i)) {
+            index[n] = i;
+            items[n].command = LC709204F_SNAPSHOT_FIELDS[i].command;
+            items[n++].write = false;
+        }
+    }
+
+    execute(items, n);
+
+    for (uint8_t j = 0; j < n; j++) {
+        if (items[j].status == LC709204F_STATUS_OK) {
+            *(uint16_t *)(base + LC709204F_SNAPSHOT_FIELDS[index[j]].offset) = items[j].value;
+            snapshot.valid |= 1 << index[j];
+        }
+    }
+
+    return snapshot.valid == fields;
+}
+
+/**
+ * Read Register
  *
- * Reads 16 bits of CRC data from the chip.
- * Note this function performs a CRC on data that includes the I2C
- * write address, command, read address and 2 bytes of response.
+ * Reads a register with a single transfer and reports how the transfer went, so a value of 0
+ * can be told apart from a bus error without reading again.
  *
  * @param command The I2C register/command
- * @param data Pointer to uint16_t value to store the response
- * @return True on successful I2C read
+ * @return Register value and transfer status, the value is 0 unless the status is LC709204F_STATUS_OK
  */
-bool LC709204F::readWord(uint8_t command, uint16_t *data) {
-    uint8_t reply[6];
-    reply[0] = LC709204F_I2CADDR * 2;
-    reply[1] = command;
-    reply[2] = reply[0] | 0x1;
+lc709204f_result_t LC709204F::readRegister(uint8_t command) {
+    lc709204f_result_t result;
 
-    if (!i2cWriteThenRead(&command, 1, reply + 3, 3)) {
-        return false;
+    if (readWord(command, &result.value)) {
+        result.status = LC709204F_STATUS_OK;
+    } else {
+        result.value = 0;
+        result.status = _lastStatus;
     }
+    return result;
+}
+
+/**
+ * Execute
+ *
+ * Performs several register reads and writes, in order, as few transport calls: the transport
+ * joins them with repeated STARTs when it can (eg: one ioctl on Linux), the Wire transports
+ * send them back to back. Reads served by the shadow register file and elided writes do not
+ * reach the bus; they are decided against the values the earlier items leave behind. A failed
+ * item does not stop the others.
+ *
+ * @param items Items to perform, each gets its value (reads) and status
+ * @param count Number of items
+ * @return True if every item succeeded, getLastStatus() is the status of the last failure otherwise
+ */
+bool LC709204F::execute(lc709204f_batch_item_t *items, uint8_t count) {
+    lc709204f_transfer_t transfers[LC709204F_BATCH_CHUNK];
+    uint8_t buffers[LC709204F_BATCH_CHUNK][4];
+    uint8_t slots[LC709204F_BATCH_CHUNK];
+    lc709204f_status_t status = LC709204F_STATUS_OK;
+    uint8_t next = 0;
+    size_t done;
+
+    while (next < count) {
+        uint8_t n = 0;
+        uint16_t written = 0;
+
+        // Up to a chunk of items that need the bus
+        for (; next < count && n < LC709204F_BATCH_CHUNK; next++) {
+            lc709204f_batch_item_t &item = items[next];
+            int8_t slot = _shadowEnabled ? shadowSlot(item.command) : -1;
+
+            // The shadow does not know yet about the writes of the chunk: send them first
+            if (slot >= 0 && (written & (1 << slot)))
+                break;
+
+            item.status = LC709204F_STATUS_OK;
+
+            if (item.write ? elideWrite(item.command, item.value, false) : shadowRead(item.command, &item.value))
+                continue;
+
+            if (item.write) {
+                written |= slot >= 0 ? 1 << slot : item.command == LC709204F_REG_BATTERY_STATUS ? 0xFFFF : 0;
+                encodeWrite(item.command, item.value, buffers[n]);
+                transfers[n].writeLen = 4;
+                transfers[n].read = NULL;
+            } else {
+                buffers[n][0] = item.command;
+                _readsIssued++;
+                transfers[n].writeLen = 1;
+                transfers[n].read = buffers[n] + 1;
+                transfers[n].readLen = 3;
+            }
+            transfers[n].write = buffers[n];
+            slots[n++] = next;
+        }
 
-    uint8_t crc = crc8(reply, 5);
-    // CRC failure?
-    if (crc != reply[5])
-        return false;
+        // A failed transfer is skipped, the rest of the chunk is sent again
+        for (uint8_t pos = 0; pos < n; pos += done + 1) {
+            LC709204F_STAT(unsigned long start = micros());
+            uint8_t code = _transport.transfer(_address, transfers + pos, n - pos, &done);
+            LC709204F_STAT(recordTransfer(0xFF, false, start));
 
-    *data = reply[4];
-    *data <<= 8;
-    *data |= reply[3];
+            for (uint8_t j = pos; j < pos + done; j++) {
+                lc709204f_batch_item_t &item = items[slots[j]];
 
-    return true;
+                LC709204F_STAT(if (item.command < LC709204F_REG_COUNT) (item.write ? _stats.writes : _stats.reads)[item.command]++);
+
+                if (item.write) {
+                    shadowStore(item.command, item.value);
+                } else if (!decodeReply(item.command, transfers[j].read, &item.value)) {
+                    item.value = 0;
+                    item.status = status = LC709204F_STATUS_CRC;
+                }
+            }
+
+            if (code == 0)
+                break;
+
+            lc709204f_batch_item_t &failed = items[slots[pos + done]];
+
+            transportStatus(code);
+            failed.status = status = _lastStatus;
+            if (!failed.write)
+                failed.value = 0;
+        }
+    }
+
+    _lastStatus = status;
+    return status == LC709204F_STATUS_OK;
 }
 
 /**
- * readWord
+ * Write Register
  *
- * Writes 16 bits of CRC data to the chip.
- * Note this function performs a CRC on data that includes the I2C
- * write address, command, and 2 bytes of response.
+ * Writes a register by command code, eg: from a table of configuration registers.
+ * The write is skipped when the shadow register file already holds the value.
  *
  * @param command The I2C register/command
- * @param data Pointer to uint16_t value to write
- * @return True on successful I2C write
+ * @param value 16-bit value to write
+ * @return True on I2C command success, see getLastStatus() otherwise
  */
-bool LC709204F::writeWord(uint8_t command, uint16_t data) {
-    uint8_t send[5];
-    send[0] = LC709204F_I2CADDR * 2;
-    send[1] = command;
-    send[2] = data & 0xFF;
-    send[3] = data >> 8;
-    send[4] = crc8(send, 4);
-
-    return i2cWrite(send + 1, 4);
+bool LC709204F::writeRegister(uint8_t command, uint16_t value) {
+    return writeWord(command, value);
 }
 
 /**
- * CRC8 calculation.
- *
- * @param data Pointer to the data to use when calculating the CRC8.
- * @param len The number of bytes in 'data'.
+ * Read TimeToEmpty (0x03)
  *
- * @return Calculated CRC8 value.
+ * @return Result of reading LC709204F_REG_TIME_TO_EMPTY, in minutes
  */
-uint8_t LC709204F::crc8(uint8_t *data, int len) {
-    const uint8_t POLYNOMIAL(0x07);
-    uint8_t crc(0x00);
-
-    for (int j = len; j; --j) {
-        crc ^= *data++;
-
-        for (int i = 8; i; --i) {
-            crc = (crc & 0x80) ? (crc << 1) ^ POLYNOMIAL : (crc << 1);
-        }
-    }
-    return crc;
+lc709204f_result_t LC709204F::readTimeToEmpty(void) {
+    return readRegister(LC709204F_REG_TIME_TO_EMPTY);
 }
 
 /**
- * I2C write followed by read.
+ * Read TimeToFull (0x05)
  *
- * @param write_buffer
- * @param write_len
- * @param read_buffer
- * @param read_len
- * @return True on successful I2C operation
+ * @return Result of reading LC709204F_REG_TIME_TO_FULL, in minutes
  */
-bool LC709204F::i2cWriteThenRead(const uint8_t *write_buffer, size_t write_len, uint8_t *read_buffer, size_t read_len, bool stop) {
-    if (!i2cWrite(write_buffer, write_len, stop)) {
-        return false;
-    }
-
-    return i2cRead(read_buffer, read_len);
+lc709204f_result_t LC709204F::readTimeToFull(void) {
+    return readRegister(LC709204F_REG_TIME_TO_FULL);
 }
 
 /**
- * I2C Write.
+ * Read Cell Temperature (0x08)
  *
- * @param buffer
- * @param len
- * @return True on successful I2C operation
+ * @return Result of reading LC709204F_REG_CELL_TEMPERATURE_TSENSE1, in 0.1K
  */
-bool LC709204F::i2cWrite(const uint8_t *buffer, size_t len, bool stop) {
-    _wire->beginTransmission(LC709204F_I2CADDR);
+lc709204f_result_t LC709204F::readCellTemperatureTSENSE1(void) {
+    return readRegister(LC709204F_REG_CELL_TEMPERATURE_TSENSE1);
+}
 
-    // Write the data itself
-    if (_wire->write(buffer, len) != len) {
-        return false;
-    }
+/**
+ * Read Cell Voltage (0x09)
+ *
+ * @return Result of reading LC709204F_REG_CELL_VOLTAGE, in mV
+ */
+lc709204f_result_t LC709204F::readCellVoltage(void) {
+    return readRegister(LC709204F_REG_CELL_VOLTAGE);
+}
+
+/**
+ * Read RSOC (0x0D)
+ *
+ * @return Result of reading LC709204F_REG_RSOC, in %
+ */
+lc709204f_result_t LC709204F::readRSOC(void) {
+    return readRegister(LC709204F_REG_RSOC);
+}
 
-    if (_wire->endTransmission(stop) == 0) {
+/**
+ * Read ITE (0x0F)
+ *
+ * @return Result of reading LC709204F_REG_ITE, in 0.1%
+ */
+lc709204f_result_t LC709204F::readITE(void) {
+    return readRegister(LC709204F_REG_ITE);
+}
+
+/**
+ * Read Cycle Count (0x17)
+ *
+ * @return Result of reading LC709204F_REG_CYCLE_COUNT
+ */
+lc709204f_result_t LC709204F::readCycleCount(void) {
+    return readRegister(LC709204F_REG_CYCLE_COUNT);
+}
+
+/**
+ * Read Battery Status (0x19)
+ *
+ * @return Result of reading LC709204F_REG_BATTERY_STATUS
+ */
+lc709204f_result_t LC709204F::readBatteryStatus(void) {
+    return readRegister(LC709204F_REG_BATTERY_STATUS);
+}
+
+/**
+ * Read Ambient Temperature (0x30)
+ *
+ * @return Result of reading LC709204F_REG_AMBIENT_TEMPERATURE_TSENSE2, in 0.1K
+ */
+lc709204f_result_t LC709204F::readAmbientTemperatureTSENSE2(void) {
+    return readRegister(LC709204F_REG_AMBIENT_TEMPERATURE_TSENSE2);
+}
+
+/**
+ * Read State Of Health (0x32)
+ *
+ * @return Result of reading LC709204F_REG_STATE_OF_HEALTH, in %
+ */
+lc709204f_result_t LC709204F::readStateOfHealth(void) {
+    return readRegister(LC709204F_REG_STATE_OF_HEALTH);
+}
+
+/**
+ * Converts temperature register values (0.1K) to 0.1°C.
+ *
+ * @param deciKelvin Register values, eg: the temperature fields of a lc709204f_battery_snapshot_t
+ * @param deciCelsius Array to store the converted values
+ * @param count Number of values
+ */
+void LC709204F::toDeciCelsius(const uint16_t *deciKelvin, int16_t *deciCelsius, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        deciCelsius[i] = toDeciCelsius(deciKelvin[i]);
+    }
+}
+
+/**
+ * Converts temperatures in 0.1°C to temperature register values (0.1K).
+ *
+ * @param deciCelsius Temperatures
+ * @param deciKelvin Array to store the register values
+ * @param count Number of values
+ */
+void LC709204F::fromDeciCelsius(const int16_t *deciCelsius, uint16_t *deciKelvin, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        deciKelvin[i] = fromDeciCelsius(deciCelsius[i]);
+    }
+}
+
+/**
+ * Get Last Status
+ *
+ * @return Status of the last register transfer, including the ones done by the get/set functions
+ */
+lc709204f_status_t LC709204F::getLastStatus(void) {
+    return _lastStatus;
+}
+
+/**
+ * Enable Shadow
+ *
+ * Keeps a RAM copy of the R/W configuration registers. Successful reads and writes
+ * of those registers update the copy, and later reads are served from RAM without
+ * any bus traffic. The copy is dropped when BatteryStatus reports a power on reset.
+ *
+ * @param enable True to serve configuration reads from the shadow register file
+ */
+void LC709204F::enableShadow(bool enable) {
+    _shadowEnabled = enable;
+    _shadowValid = 0;
+}
+
+/**
+ * Invalidate Shadow
+ *
+ * Drops the shadow register file, the next read of every configuration register goes to the bus.
+ */
+void LC709204F::invalidateShadow(void) {
+    _shadowValid = 0;
+}
+
+/**
+ * Refresh Shadow
+ *
+ * Reloads every shadowed configuration register from the LC709204F.
+ *
+ * @return True if all shadowed registers were read successfully
+ */
+bool LC709204F::refreshShadow(void) {
+    bool success = true;
+    uint16_t val;
+
+    _shadowValid = 0;
+
+    for (uint8_t i = 0; i < LC709204F_SHADOW_SIZE; i++) {
+        if (!readWord(LC709204F_SHADOW_REGISTERS[i], &val))
+            success = false;
+    }
+
+    return success;
+}
+
+/**
+ * Set Write Elision
+ *
+ * While the shadow register file is enabled, a write of the value a configuration register
+ * is already known to hold is skipped. Disable elision to always issue the I2C write.
+ *
+ * @param enable True to skip redundant configuration writes (default)
+ */
+void LC709204F::setWriteElision(bool enable) {
+    _writeElision = enable;
+}
+
+/**
+ * Get Issued Reads
+ *
+ * @return Number of register reads sent to the LC709204F, reads served by the shadow register file excluded
+ */
+uint32_t LC709204F::getIssuedReads(void) {
+    return _readsIssued;
+}
+
+/**
+ * Get Issued Writes
+ *
+ * @return Number of register writes sent to the LC709204F
+ */
+uint32_t LC709204F::getIssuedWrites(void) {
+    return _writesIssued;
+}
+
+/**
+ * Get Elided Writes
+ *
+ * @return Number of register writes skipped because the register already held the value
+ */
+uint32_t LC709204F::getElidedWrites(void) {
+    return _writesElided;
+}
+
+/**
+ * Reset Write Counters
+ *
+ * Sets the issued read, issued write and elided write counters to 0.
+ */
+void LC709204F::resetWriteCounters(void) {
+    _readsIssued = 0;
+    _writesIssued = 0;
+    _writesElided = 0;
+}
+
+/**
+ * Submit Read
+ *
+ * Queues a register read that is carried out by later poll() calls, one bus phase per call.
+ * The result is delivered to the callback, or kept until getRequestResult() when no callback is given.
+ * While a read is in flight the command has been sent without a STOP condition, so no other
+ * device on the same bus may be accessed until poll() has completed it.
+ *
+ * @param command The I2C register/command
+ * @param callback Function called on completion (optional)
+ * @param context Pointer passed to the callback (optional)
+ * @return Request handle, or -1 if all LC709204F_ASYNC_QUEUE_SIZE slots are in use
+ */
+int8_t LC709204F::submitRead(uint8_t command, lc709204f_request_callback_t callback, void *context) {
+    return submitRequest(command, false, 0, callback, context);
+}
+
+/**
+ * Submit Write
+ *
+ * Queues a register write that is carried out by a later poll() call.
+ * Requests are carried out in submission order.
+ *
+ * @param command The I2C register/command
+ * @param data The value to write
+ * @param callback Function called on completion (optional)
+ * @param context Pointer passed to the callback (optional)
+ * @return Request handle, or -1 if all LC709204F_ASYNC_QUEUE_SIZE slots are in use
+ */
+int8_t LC709204F::submitWrite(uint8_t command, uint16_t data, lc709204f_request_callback_t callback, void *context) {
+    return submitRequest(command, true, data, callback, context);
+}
+
+/**
+ * Poll
+ *
+ * Carries out the next bus phase of the asynchronous requests: either reads the reply of the
+ * read in flight, or sends the oldest pending request. Call it repeatedly from loop().
+ *
+ * @return True while requests are still pending or in flight
+ */
+bool LC709204F::poll(void) {
+    int8_t next = -1;
+    uint8_t oldest = 0;
+    uint8_t reply[3];
+    uint8_t send[4];
+    uint16_t val;
+
+    for (uint8_t i = 0; i < LC709204F_ASYNC_QUEUE_SIZE; i++) {
+        lc709204f_request_t &request = _requests[i];
+
+        if (request.state == LC709204F_REQUEST_READING) {
+            LC709204F_STAT(if (request.command < LC709204F_REG_COUNT) _stats.reads[request.command]++);
+            bool success = _i2cRead(reply, 3) && decodeReply(request.command, reply, &request.data);
+            completeRequest(i, success);
+            return true;
+        }
+
+        if (request.state == LC709204F_REQUEST_PENDING) {
+            uint8_t age = _requestSequence - request.sequence;
+            if (next < 0 || age > oldest) {
+                next = i;
+                oldest = age;
+            }
+        }
+    }
+
+    if (next < 0)
+        return false;
+
+    lc709204f_request_t &request = _requests[next];
+
+    if (request.write) {
+        if (elideWrite(request.command, request.data, false)) {
+            completeRequest(next, true);
+        } else {
+            encodeWrite(request.command, request.data, send);
+            LC709204F_STAT(if (request.command < LC709204F_REG_COUNT) _stats.writes[request.command]++);
+            bool success = i2cWrite(send, 4);
+            if (success)
+                shadowStore(request.command, request.data);
+            completeRequest(next, success);
+        }
+    } else if (shadowRead(request.command, &val)) {
+        request.data = val;
+        completeRequest(next, true);
+    } else {
+        _readsIssued++;
+        if (i2cWrite(&request.command, 1, false))
+            request.state = LC709204F_REQUEST_READING;
+        else
+            completeRequest(next, false);
+    }
+
+    return true;
+}
+
+/**
+ * Get Request State
+ *
+ * @param handle Request handle
+ * @return State of the request
+ */
+lc709204f_request_state_t LC709204F::getRequestState(int8_t handle) {
+    if (handle < 0 || handle >= LC709204F_ASYNC_QUEUE_SIZE)
+        return LC709204F_REQUEST_FREE;
+
+    return (lc709204f_request_state_t) _requests[handle].state;
+}
+
+/**
+ * Get Request Result
+ *
+ * Collects the result of a completed request submitted without callback and releases its handle.
+ *
+ * @param handle Request handle
+ * @param data Pointer to uint16_t value to store the value read or written
+ * @return True if the request completed successfully
+ */
+bool LC709204F::getRequestResult(int8_t handle, uint16_t *data) {
+    lc709204f_request_state_t state = getRequestState(handle);
+
+    if (state != LC709204F_REQUEST_DONE && state != LC709204F_REQUEST_FAILED)
+        return false;
+
+    _requests[handle].state = LC709204F_REQUEST_FREE;
+    *data = _requests[handle].data;
+
+    return state == LC709204F_REQUEST_DONE;
+}
+
+/**
+ * Request submission helper.
+ *
+ * @return Request handle, or -1 if the queue is full
+ */
+int8_t LC709204F::submitRequest(uint8_t command, bool write, uint16_t data, lc709204f_request_callback_t callback, void *context) {
+    for (uint8_t i = 0; i < LC709204F_ASYNC_QUEUE_SIZE; i++) {
+        lc709204f_request_t &request = _requests[i];
+
+        if (request.state != LC709204F_REQUEST_FREE)
+            continue;
+
+        request.state = LC709204F_REQUEST_PENDING;
+        request.command = command;
+        request.sequence = _requestSequence++;
+        request.write = write;
+        request.data = data;
+        request.callback = callback;
+        request.context = context;
+        return i;
+    }
+
+    return -1;
+}
+
+/**
+ * Request completion helper.
+ *
+ * Hands the result to the callback and releases the slot, or keeps it for getRequestResult().
+ */
+void LC709204F::completeRequest(int8_t handle, bool success) {
+    lc709204f_request_t &request = _requests[handle];
+
+    request.state = success ? LC709204F_REQUEST_DONE : LC709204F_REQUEST_FAILED;
+
+    if (request.callback) {
+        request.state = LC709204F_REQUEST_FREE;
+        request.callback(handle, success, request.data, request.context);
+    }
+}
+
+#if defined(LC709204F_STATS)
+/**
+ * Get Stats
+ *
+ * @return Bus instrumentation counters since the last resetStats()
+ */
+const lc709204f_stats_t &LC709204F::getStats(void) {
+    return _stats;
+}
+
+/**
+ * Reset Stats
+ *
+ * Sets all bus instrumentation counters to 0.
+ */
+void LC709204F::resetStats(void) {
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+/**
+ * Transfer instrumentation helper.
+ *
+ * Counts a register transfer and adds its duration to the latency histogram.
+ *
+ * @param command The I2C register/command
+ * @param write True for writeWord, false for readWord
+ * @param start micros() when the transfer started
+ */
+void LC709204F::recordTransfer(uint8_t command, bool write, unsigned long start) {
+    unsigned long elapsed = micros() - start;
+    uint8_t bucket = 0;
+
+    while (elapsed && bucket < LC709204F_LATENCY_BUCKETS - 1) {
+        elapsed >>= 1;
+        bucket++;
+    }
+    _stats.latency[bucket]++;
+
+    if (command < LC709204F_REG_COUNT) {
+        if (write)
+            _stats.writes[command]++;
+        else
+            _stats.reads[command]++;
+    }
+}
+#endif
+
+/**
+ * readWord
+ *
+ * Reads 16 bits of CRC data from the chip.
+ * Note this function performs a CRC on data that includes the I2C
+ * write address, command, read address and 2 bytes of response.
+ *
+ * @param command The I2C register/command
+ * @param data Pointer to uint16_t value to store the response
+ * @return True on successful I2C read
+ */
+bool LC709204F::readWord(uint8_t command, uint16_t *data) {
+    uint8_t reply[3];
+
+    if (shadowRead(command, data)) {
+        _lastStatus = LC709204F_STATUS_OK;
+        return true;
+    }
+
+    _readsIssued++;
+
+    LC709204F_STAT(unsigned long start = micros());
+    bool success = i2cWriteThenRead(&command, 1, reply, 3) && decodeReply(command, reply, data);
+    LC709204F_STAT(recordTransfer(command, false, start));
+
+    return success;
+}
+
+/**
+ * readDoubleWord
+ *
+ * Reads a 32-bit value held in two 16-bit registers without tearing.
+ * The higher 16bit is read before and, only when the lower 16bit is below the rollover
+ * window, after the lower 16bit. If it changed, the lower 16bit carried in between and the
+ * second higher 16bit belongs with it. A counter far from a carry costs 2 transfers, one
+ * that may just have carried costs 3.
+ *
+ * @param lower The I2C register/command of the lower 16bit
+ * @param higher The I2C register/command of the higher 16bit
+ * @param data Pointer to uint32_t value to store the response, left unchanged on failure
+ * @param rolloverWindow Lower 16bit values that need the higher 16bit read again, 0 for values that never carry
+ * @return True if all transfers succeeded, getLastStatus() tells why otherwise
+ */
+bool LC709204F::readDoubleWord(uint8_t lower, uint8_t higher, uint32_t *data, uint16_t rolloverWindow) {
+    uint16_t lo;
+    uint16_t hi;
+
+    if (!readWord(higher, &hi) || !readWord(lower, &lo))
+        return false;
+
+    if (lo < rolloverWindow && !readWord(higher, &hi))
+        return false;
+
+    *data = (uint32_t) hi << 16 | lo;
+    return true;
+}
+
+/**
+ * writeWord
+ *
+ * Writes 16 bits of CRC data to the chip.
+ * Note this function performs a CRC on data that includes the I2C
+ * write address, command, and 2 bytes of response.
+ * When the shadow register file already holds the value, the write is skipped unless forced.
+ *
+ * @param command The I2C register/command
+ * @param data Pointer to uint16_t value to write
+ * @param force Issue the write even if the register is known to hold the value
+ * @return True on successful I2C write
+ */
+bool LC709204F::writeWord(uint8_t command, uint16_t data, bool force) {
+    uint8_t send[4];
+
+    if (elideWrite(command, data, force)) {
+        _lastStatus = LC709204F_STATUS_OK;
         return true;
+    }
+
+    encodeWrite(command, data, send);
+
+    LC709204F_STAT(unsigned long start = micros());
+    bool success = i2cWrite(send, 4);
+    LC709204F_STAT(recordTransfer(command, true, start));
+
+    if (!success)
+        return false;
+
+    shadowStore(command, data);
+
+    return true;
+}
+
+/**
+ * Shadow read helper.
+ *
+ * @param command The I2C register/command
+ * @param data Pointer to uint16_t value to store the shadowed value
+ * @return True if the value was served from the shadow register file
+ */
+bool LC709204F::shadowRead(uint8_t command, uint16_t *data) {
+    int8_t slot = _shadowEnabled ? shadowSlot(command) : -1;
+
+    if (slot < 0 || !(_shadowValid & (1 << slot)))
+        return false;
+
+    *data = _shadow[slot];
+    return true;
+}
+
+/**
+ * Shadow store helper.
+ *
+ * Records a value known to be held by a register.
+ *
+ * @param command The I2C register/command
+ * @param data The register value
+ */
+void LC709204F::shadowStore(uint8_t command, uint16_t data) {
+    int8_t slot = _shadowEnabled ? shadowSlot(command) : -1;
+
+    if (slot >= 0) {
+        _shadow[slot] = data;
+        _shadowValid |= 1 << slot;
+    } else if (_shadowEnabled && command == LC709204F_REG_BATTERY_STATUS && (data & LC709204F_BATTERY_STATUS_INITIALIZED)) {
+        // Power on reset, the configuration registers are back to their initial values
+        invalidateShadow();
+    }
+}
+
+/**
+ * Reply decoding helper.
+ *
+ * Checks the CRC of the 3 bytes returned by a register read.
+ *
+ * @param command The I2C register/command that was read
+ * @param reply The 2 data bytes and the CRC byte returned by the chip
+ * @param data Pointer to uint16_t value to store the response
+ * @return True if the CRC matched
+ */
+bool LC709204F::decodeReply(uint8_t command, const uint8_t *reply, uint16_t *data) {
+    uint8_t crc;
+
+    if (command < LC709204F_REG_COUNT) {
+        crc = pgm_read_byte(&LC709204F_CRC8_READ_PREFIX[command]) ^ _crcReadAdjust;
     } else {
+        uint8_t prefix[3] = {(uint8_t)(_address * 2), command, (uint8_t)(_address * 2 | 0x1)};
+        crc = crc8(prefix, 3);
+    }
+    crc = crc8Update(crc, reply[0]);
+    crc = crc8Update(crc, reply[1]);
+
+    // CRC failure?
+    if (crc != reply[2]) {
+        LC709204F_STAT(_stats.crcFailures++);
+        _lastStatus = LC709204F_STATUS_CRC;
+        return false;
+    }
+
+    *data = reply[1];
+    *data <<= 8;
+    *data |= reply[0];
+
+    shadowStore(command, *data);
+
+    return true;
+}
+
+/**
+ * Write elision helper.
+ *
+ * @param command The I2C register/command
+ * @param data The value to write
+ * @param force Never skip the write
+ * @return True if the register already holds the value and the write can be skipped
+ */
+bool LC709204F::elideWrite(uint8_t command, uint16_t data, bool force) {
+    uint16_t val;
+
+    if (force || !_writeElision || !shadowRead(command, &val) || val != data)
+        return false;
+
+    _writesElided++;
+    return true;
+}
+
+/**
+ * Write encoding helper.
+ *
+ * Builds the command, 2 data bytes and CRC byte of a register write, and counts it as issued.
+ *
+ * @param command The I2C register/command
+ * @param data The value to write
+ * @param send Buffer of 4 bytes to fill
+ */
+void LC709204F::encodeWrite(uint8_t command, uint16_t data, uint8_t *send) {
+    uint8_t crc;
+
+    send[0] = command;
+    send[1] = data & 0xFF;
+    send[2] = data >> 8;
+
+    if (command < LC709204F_REG_COUNT) {
+        crc = pgm_read_byte(&LC709204F_CRC8_WRITE_PREFIX[command]) ^ _crcWriteAdjust;
+    } else {
+        uint8_t prefix[2] = {(uint8_t)(_address * 2), command};
+        crc = crc8(prefix, 2);
+    }
+    crc = crc8Update(crc, send[1]);
+    send[3] = crc8Update(crc, send[2]);
+
+    _writesIssued++;
+}
+
+/**
+ * CRC8 calculation.
+ *
+ * The lookup strategy is selected at compile time through LC709204F_CRC8_STRATEGY.
+ *
+ * @param data Pointer to the data to use when calculating the CRC8.
+ * @param len The number of bytes in 'data'.
+ *
+ * @return Calculated CRC8 value.
+ */
+uint8_t LC709204F::crc8(uint8_t *data, int len) {
+    uint8_t crc(0x00);
+
+    for (int j = len; j; --j) {
+        crc = crc8Update(crc, *data++);
+    }
+    return crc;
+}
+
+/**
+ * I2C write followed by read.
+ *
+ * @param write_buffer
+ * @param write_len
+ * @param read_buffer
+ * @param read_len
+ * @return True on successful I2C operation
+ */
+bool LC709204F::i2cWriteThenRead(const uint8_t *write_buffer, size_t write_len, uint8_t *read_buffer, size_t read_len, bool stop) {
+    if (!i2cWrite(write_buffer, write_len, stop)) {
         return false;
     }
+
+    return i2cRead(read_buffer, read_len);
+}
+
+/**
+ * I2C Write.
+ *
+ * @param buffer
+ * @param len
+ * @return True on successful I2C operation
+ */
+bool LC709204F::i2cWrite(const uint8_t *buffer, size_t len, bool stop) {
+    return transportStatus(_transport.write(_address, buffer, len, stop));
+}
+
+/**
+ * Transport code helper.
+ *
+ * @param code Transport code, those of endTransmission: 0 success, 1 data too long, 2 address NACK,
+ *             3 data NACK, 4 other error, 5 timeout, or LC709204F_TRANSPORT_SHORT_READ
+ * @return True on success, getLastStatus() tells why otherwise
+ */
+bool LC709204F::transportStatus(uint8_t code) {
+    switch (code) {
+        case 0:
+            _lastStatus = LC709204F_STATUS_OK;
+            return true;
+        case 2:
+        case 3:
+            LC709204F_STAT(_stats.nacks++);
+            _lastStatus = LC709204F_STATUS_NACK;
+            return false;
+        case 5:
+            _lastStatus = LC709204F_STATUS_TIMEOUT;
+            return false;
+        case LC709204F_TRANSPORT_SHORT_READ:
+            LC709204F_STAT(_stats.shortReads++);
+            _lastStatus = LC709204F_STATUS_SHORT_READ;
+            return false;
+        default:
+            _lastStatus = LC709204F_STATUS_BUS_ERROR;
+            return false;
+    }
 }
 
 /**
@@ -1366,22 +2591,14 @@ bool LC709204F::i2cRead(uint8_t *buffer, size_t len, bool stop) {
  * @return True on successful I2C operation
  */
 bool LC709204F::_i2cRead(uint8_t *buffer, size_t len, bool stop) {
-#if defined(TinyWireM_h)
-    size_t recv = _wire->requestFrom((uint8_t)LC709204F_I2CADDR, (uint8_t)len);
-#elif defined(ARDUINO_ARCH_MEGAAVR)
-    size_t recv = _wire->requestFrom(LC709204F_I2CADDR, len, stop);
-#else
-    size_t recv = _wire->requestFrom((uint8_t) LC709204F_I2CADDR, (uint8_t) len, (uint8_t) stop);
-#endif
+    size_t recv = _transport.read(_address, buffer, len, stop);
 
     if (recv != len) {
         // Not enough data available to fulfill our obligation!
+        LC709204F_STAT(_stats.shortReads++);
+        _lastStatus = LC709204F_STATUS_SHORT_READ;
         return false;
     }
 
-    for (uint16_t i = 0; i < len; i++) {
-        buffer[i] = _wire->read();
-    }
-
     return true;
 }
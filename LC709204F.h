@@ -9,12 +9,30 @@
 #ifndef _LC709204F_H
 #define _LC709204F_H
 
-#include "Arduino.h"
-#include "Wire.h"
+#include "LC709204FTransport.h"
 
 /// See datasheet for details: https://www.onsemi.com/download/data-sheet/pdf/lc709204f-d.pdf
 #define LC709204F_I2CADDR 0x0B /// LC709204F default i2c address
 
+#define LC709204F_READ_BITS 57  /// SCL clocks of a register read: START, address, command, repeated START, address, 2 data bytes, CRC, STOP
+#define LC709204F_WRITE_BITS 47 /// SCL clocks of a register write: START, address, command, 2 data bytes, CRC, STOP
+
+/**
+ * CRC-8 (polynomial 0x07) strategies used to protect every register transfer.
+ *
+ * Select one with -DLC709204F_CRC8_STRATEGY=... in the build flags:
+ * - LC709204F_CRC8_TABLE: 256-entry lookup table in flash, one lookup per byte (default)
+ * - LC709204F_CRC8_NIBBLE: 16-entry lookup table, two lookups per byte, for flash/RAM-starved AVR parts
+ * - LC709204F_CRC8_BITWISE: no table, 8 shift/xor steps per byte
+ */
+#define LC709204F_CRC8_BITWISE 0
+#define LC709204F_CRC8_NIBBLE  1
+#define LC709204F_CRC8_TABLE   2
+
+#ifndef LC709204F_CRC8_STRATEGY
+#define LC709204F_CRC8_STRATEGY LC709204F_CRC8_TABLE
+#endif
+
 #define LC709204F_REG_TIME_TO_EMPTY                        0x03 /// R - Displays estimated time to empty.
 #define LC709204F_REG_BEFORE_RSOC                          0x04 /// W - Optional Command, especially for obtaining the voltage with intentional timing after power on reset.
 #define LC709204F_REG_TIME_TO_FULL                         0x05 /// R - Displays estimated time to full.
@@ -58,6 +76,54 @@
 #define LC709204F_REG_USER_ID_LOWER_16BIT                  0x36 /// R - Displays 32bit User Id (lower 16bit).
 #define LC709204F_REG_USER_ID_HIGHER_16BIT                 0x37 /// R - Displays 32bit User Id (higher 16bit).
 
+#define LC709204F_REG_COUNT (LC709204F_REG_USER_ID_HIGHER_16BIT + 1) /// Number of command codes, 0x00 up to the last register.
+
+#define LC709204F_SHADOW_SIZE 16 /// Number of R/W configuration registers kept in the shadow register file.
+
+#define LC709204F_BATTERY_STATUS_HIGH_CELL_VOLTAGE 0x8000 /// BatteryStatus alarm: CellVoltage above AlarmHighCellVoltage.
+#define LC709204F_BATTERY_STATUS_HIGH_TEMPERATURE  0x1000 /// BatteryStatus alarm: CellTemperature above AlarmHighTemperature.
+#define LC709204F_BATTERY_STATUS_LOW_CELL_VOLTAGE  0x0800 /// BatteryStatus alarm: CellVoltage below AlarmLowCellVoltage.
+#define LC709204F_BATTERY_STATUS_LOW_RSOC          0x0200 /// BatteryStatus alarm: RSOC below AlarmLowRSOC.
+#define LC709204F_BATTERY_STATUS_LOW_TEMPERATURE   0x0100 /// BatteryStatus alarm: CellTemperature below AlarmLowTemperature.
+#define LC709204F_BATTERY_STATUS_INITIALIZED       0x0080 /// BatteryStatus bit set by the LC709204F after a power on reset.
+#define LC709204F_BATTERY_STATUS_DISCHARGING       0x0040 /// BatteryStatus bit: battery discharging.
+
+#define LC709204F_BATTERY_STATUS_ALARMS (LC709204F_BATTERY_STATUS_HIGH_CELL_VOLTAGE | LC709204F_BATTERY_STATUS_HIGH_TEMPERATURE | \
+                                         LC709204F_BATTERY_STATUS_LOW_CELL_VOLTAGE | LC709204F_BATTERY_STATUS_LOW_RSOC | \
+                                         LC709204F_BATTERY_STATUS_LOW_TEMPERATURE) /// Alarm bits, any of them asserts ALARMB.
+
+#define LC709204F_ZERO_CELSIUS 2732 /// 0°C in the 0.1K unit of the temperature registers.
+
+#ifndef LC709204F_ROLLOVER_WINDOW
+#define LC709204F_ROLLOVER_WINDOW 0x0100 /// 32-bit counters: lower 16bit values below this may have just carried into the higher 16bit.
+#endif
+
+/**
+ * Bus instrumentation
+ *
+ * Build with -DLC709204F_STATS to count transfers, errors and latencies in readWord/writeWord.
+ * Without it the instrumentation code and counters are not compiled in.
+ */
+#define LC709204F_LATENCY_BUCKETS 16 /// Latency histogram buckets, bucket n counts transfers of 2^(n-1) to 2^n - 1 us.
+
+#if defined(LC709204F_STATS)
+#define LC709204F_STAT(expr) expr
+#else
+#define LC709204F_STAT(expr)
+#endif
+
+#ifndef LC709204F_BATCH_CHUNK
+#if defined(__AVR__)
+#define LC709204F_BATCH_CHUNK 4 /// Batch items handed to the transport at once, each takes a descriptor and 4 bytes of stack.
+#else
+#define LC709204F_BATCH_CHUNK 16 /// Batch items handed to the transport at once, each takes a descriptor and 4 bytes of stack.
+#endif
+#endif
+
+#ifndef LC709204F_ASYNC_QUEUE_SIZE
+#define LC709204F_ASYNC_QUEUE_SIZE 4 /// Number of asynchronous requests that can be in flight at once.
+#endif
+
 /**
  * Value to initialize RSOC
  */
@@ -117,16 +183,137 @@ typedef enum {
     LC709204F_POWER_MODE_SLEEP = 0x0002,
 } lc709204f_power_mode_t;
 
+/**
+ * BatterySnapshot fields, used as bits of the field mask and of the validity mask
+ */
+typedef enum {
+    LC709204F_FIELD_CELL_VOLTAGE = 0x0001,
+    LC709204F_FIELD_RSOC = 0x0002,
+    LC709204F_FIELD_ITE = 0x0004,
+    LC709204F_FIELD_TIME_TO_EMPTY = 0x0008,
+    LC709204F_FIELD_TIME_TO_FULL = 0x0010,
+    LC709204F_FIELD_CELL_TEMPERATURE = 0x0020,
+    LC709204F_FIELD_AMBIENT_TEMPERATURE = 0x0040,
+    LC709204F_FIELD_BATTERY_STATUS = 0x0080,
+    LC709204F_FIELD_CYCLE_COUNT = 0x0100,
+    LC709204F_FIELD_STATE_OF_HEALTH = 0x0200,
+    LC709204F_FIELD_ALL = 0x03FF,
+} lc709204f_snapshot_field_t;
+
+/**
+ * BatterySnapshot - raw register values, in register units
+ */
+typedef struct {
+    uint16_t cellVoltage;        /// mV
+    uint16_t rsoc;               /// %
+    uint16_t ite;                /// 0.1%
+    uint16_t timeToEmpty;        /// minutes
+    uint16_t timeToFull;         /// minutes
+    uint16_t cellTemperature;    /// 0.1K
+    uint16_t ambientTemperature; /// 0.1K
+    uint16_t batteryStatus;
+    uint16_t cycleCount;         /// count
+    uint16_t stateOfHealth;      /// %
+    uint16_t valid;              /// lc709204f_snapshot_field_t bits of the fields read successfully
+} lc709204f_battery_snapshot_t;
+
+/**
+ * Asynchronous request state
+ */
+typedef enum {
+    LC709204F_REQUEST_FREE = 0,    /// Slot not in use / handle released
+    LC709204F_REQUEST_PENDING = 1, /// Queued, nothing sent yet
+    LC709204F_REQUEST_READING = 2, /// Command sent, reply not read yet
+    LC709204F_REQUEST_DONE = 3,    /// Completed successfully
+    LC709204F_REQUEST_FAILED = 4,  /// Completed with an I2C or CRC error
+} lc709204f_request_state_t;
+
+/**
+ * Asynchronous request completion callback
+ *
+ * @param handle The handle returned by submitRead/submitWrite
+ * @param success True if the request completed successfully
+ * @param data The value read (reads) or written (writes)
+ * @param context The context pointer passed at submission
+ */
+typedef void (*lc709204f_request_callback_t)(int8_t handle, bool success, uint16_t data, void *context);
+
+/**
+ * Asynchronous request slot
+ */
+typedef struct {
+    uint8_t state;
+    uint8_t command;
+    uint8_t sequence;
+    bool write;
+    uint16_t data;
+    lc709204f_request_callback_t callback;
+    void *context;
+} lc709204f_request_t;
+
+/**
+ * Outcome of the last register transfer
+ */
+typedef enum {
+    LC709204F_STATUS_OK = 0,         /// Transfer completed and CRC matched
+    LC709204F_STATUS_NACK = 1,       /// Address or data not acknowledged
+    LC709204F_STATUS_CRC = 2,        /// Reply received with a wrong CRC
+    LC709204F_STATUS_SHORT_READ = 3, /// Less data received than requested
+    LC709204F_STATUS_TIMEOUT = 4,    /// Bus timeout reported by the Wire library
+    LC709204F_STATUS_BUS_ERROR = 5,  /// Any other Wire error (buffer overflow, arbitration lost, ...)
+} lc709204f_status_t;
+
+/**
+ * Register value together with the status of the transfer that read it
+ */
+typedef struct {
+    uint16_t value;            /// Register value, 0 unless status is LC709204F_STATUS_OK
+    lc709204f_status_t status; /// Outcome of the read
+} lc709204f_result_t;
+
+/**
+ * Batch item: one register read or write of a LC709204F::execute() call
+ */
+typedef struct {
+    uint8_t command;           /// The I2C register/command
+    bool write;                /// True to write value, false to read into value
+    uint16_t value;            /// Value to write, or value read
+    lc709204f_status_t status; /// Outcome of the item, reads are LC709204F_STATUS_OK only with a matching CRC
+} lc709204f_batch_item_t;
+
+/**
+ * Transport of the bus class the driver is compiled for, see LC709204F_BUS
+ */
+typedef LC709204FTransport<LC709204F_BUS> lc709204f_transport_t;
+
+/**
+ * Bus instrumentation counters (LC709204F_STATS builds)
+ */
+typedef struct {
+    uint16_t reads[LC709204F_REG_COUNT];  /// Register reads sent to the bus, per command
+    uint16_t writes[LC709204F_REG_COUNT]; /// Register writes sent to the bus, per command
+    uint16_t crcFailures;                 /// Replies with a wrong CRC
+    uint16_t nacks;                       /// Write transfers not acknowledged
+    uint16_t shortReads;                  /// Read transfers returning less data than requested
+    uint16_t latency[LC709204F_LATENCY_BUCKETS]; /// readWord/writeWord duration histogram, log2 of microseconds
+} lc709204f_stats_t;
+
 /**
  * LC709204F I2C battery monitor
  */
 class LC709204F {
 public:
-    LC709204F(TwoWire *theWire = &Wire);
+    LC709204F(LC709204F_BUS *theWire = LC709204F_DEFAULT_BUS, uint8_t address = LC709204F_I2CADDR);
 
     ~LC709204F();
 
-    bool init(lc709204f_apa_adjustment_t APAAdjustment, lc709204f_battery_profile_t batteryProfile, TwoWire *wire = &Wire);
+    bool init(lc709204f_apa_adjustment_t APAAdjustment, lc709204f_battery_profile_t batteryProfile, LC709204F_BUS *wire = LC709204F_DEFAULT_BUS);
+
+    bool warmInit(lc709204f_apa_adjustment_t APAAdjustment, lc709204f_battery_profile_t batteryProfile, bool *warm = NULL);
+
+    void setAddress(uint8_t address);
+
+    uint8_t getAddress(void);
 
     uint16_t getTimeToEmpty(void);
 
@@ -144,10 +331,14 @@ public:
 
     float getCellTemperature(void);
 
+    int16_t getCellTemperatureDeciC(void);
+
     bool setCellTemperatureTSENSE1(uint16_t b);
 
     bool setCellTemperature(float temperature);
 
+    bool setCellTemperatureDeciC(int16_t deciCelsius);
+
     uint16_t getCellVoltage(void);
 
     uint16_t getCurrentDirection(void);
@@ -224,10 +415,18 @@ public:
 
     bool setAlarmLowTemperature(float temp);
 
+    int16_t getAlarmLowTemperatureDeciC(void);
+
+    bool setAlarmLowTemperatureDeciC(int16_t deciCelsius);
+
     float getAlarmHighTemperature(void);
 
     bool setAlarmHighTemperature(float temp);
 
+    int16_t getAlarmHighTemperatureDeciC(void);
+
+    bool setAlarmHighTemperatureDeciC(int16_t deciCelsius);
+
     uint32_t getTotalRunTime(void);
 
     bool setTotalRunTime(uint32_t b);
@@ -252,38 +451,180 @@ public:
 
     float getMaximumCellTemperature(void);
 
+    int16_t getMaximumCellTemperatureDeciC(void);
+
     bool setMaximumCellTemperatureTSENSE1(uint16_t b);
 
     bool setMaximumCellTemperature(float temperature);
 
+    bool setMaximumCellTemperatureDeciC(int16_t deciCelsius);
+
     uint16_t getMinimumCellTemperatureTSENSE1(void);
 
     float getMinimumCellTemperature(void);
 
+    int16_t getMinimumCellTemperatureDeciC(void);
+
     bool setMinimumCellTemperatureTSENSE1(uint16_t b);
 
     bool setMinimumCellTemperature(float temperature);
 
+    bool setMinimumCellTemperatureDeciC(int16_t deciCelsius);
+
     uint16_t getAmbientTemperatureTSENSE2(void);
 
     float getAmbientTemperature(void);
 
+    int16_t getAmbientTemperatureDeciC(void);
+
+    bool readTemperaturesDeciC(int16_t *cell, int16_t *ambient);
+
     uint16_t getStateOfHealth(void);
 
     uint32_t getUserId(void);
 
+    bool readSnapshot(lc709204f_battery_snapshot_t &snapshot, uint16_t fields = LC709204F_FIELD_ALL);
+
+    lc709204f_result_t readRegister(uint8_t command);
+
+    bool writeRegister(uint8_t command, uint16_t value);
+
+    bool execute(lc709204f_batch_item_t *items, uint8_t count);
+
+    lc709204f_result_t readTimeToEmpty(void);
+
+    lc709204f_result_t readTimeToFull(void);
+
+    lc709204f_result_t readCellTemperatureTSENSE1(void);
+
+    lc709204f_result_t readCellVoltage(void);
+
+    lc709204f_result_t readRSOC(void);
+
+    lc709204f_result_t readITE(void);
+
+    lc709204f_result_t readCycleCount(void);
+
+    lc709204f_result_t readBatteryStatus(void);
+
+    lc709204f_result_t readAmbientTemperatureTSENSE2(void);
+
+    lc709204f_result_t readStateOfHealth(void);
+
+    lc709204f_status_t getLastStatus(void);
+
+    /**
+     * Converts a temperature register value (0.1K) to 0.1°C.
+     */
+    static constexpr int16_t toDeciCelsius(uint16_t deciKelvin) {
+        return (int16_t)(deciKelvin - LC709204F_ZERO_CELSIUS);
+    }
+
+    /**
+     * Converts a temperature in 0.1°C to a temperature register value (0.1K).
+     */
+    static constexpr uint16_t fromDeciCelsius(int16_t deciCelsius) {
+        return (uint16_t)(deciCelsius + LC709204F_ZERO_CELSIUS);
+    }
+
+    static void toDeciCelsius(const uint16_t *deciKelvin, int16_t *deciCelsius, size_t count);
+
+    static void fromDeciCelsius(const int16_t *deciCelsius, uint16_t *deciKelvin, size_t count);
+
+    void enableShadow(bool enable = true);
+
+    void invalidateShadow(void);
+
+    bool refreshShadow(void);
+
+    void setWriteElision(bool enable);
+
+    uint32_t getIssuedReads(void);
+
+    uint32_t getIssuedWrites(void);
+
+    uint32_t getElidedWrites(void);
+
+    void resetWriteCounters(void);
+
+    int8_t submitRead(uint8_t command, lc709204f_request_callback_t callback = NULL, void *context = NULL);
+
+    int8_t submitWrite(uint8_t command, uint16_t data, lc709204f_request_callback_t callback = NULL, void *context = NULL);
+
+    bool poll(void);
+
+    lc709204f_request_state_t getRequestState(int8_t handle);
+
+    bool getRequestResult(int8_t handle, uint16_t *data);
+
+#if defined(LC709204F_STATS)
+    const lc709204f_stats_t &getStats(void);
+
+    void resetStats(void);
+#endif
+
 private:
-    TwoWire *_wire;
+    lc709204f_transport_t _transport;
+
+    uint8_t _address;
+
+    uint8_t _crcReadAdjust;
+
+    uint8_t _crcWriteAdjust;
+
+    lc709204f_status_t _lastStatus;
+
+    bool _shadowEnabled;
+
+    uint16_t _shadowValid;
+
+    uint16_t _shadow[LC709204F_SHADOW_SIZE];
+
+    bool _writeElision;
+
+    uint32_t _readsIssued;
+
+    uint32_t _writesIssued;
+
+    uint32_t _writesElided;
+
+    lc709204f_request_t _requests[LC709204F_ASYNC_QUEUE_SIZE];
+
+    uint8_t _requestSequence;
+
+    int8_t submitRequest(uint8_t command, bool write, uint16_t data, lc709204f_request_callback_t callback, void *context);
+
+    void completeRequest(int8_t handle, bool success);
+
+#if defined(LC709204F_STATS)
+    lc709204f_stats_t _stats;
+
+    void recordTransfer(uint8_t command, bool write, unsigned long start);
+#endif
 
 protected:
     bool readWord(uint8_t address, uint16_t *data);
 
-    bool writeWord(uint8_t command, uint16_t data);
+    bool readDoubleWord(uint8_t lower, uint8_t higher, uint32_t *data, uint16_t rolloverWindow = LC709204F_ROLLOVER_WINDOW);
+
+    bool writeWord(uint8_t command, uint16_t data, bool force = false);
+
+    bool shadowRead(uint8_t command, uint16_t *data);
+
+    void shadowStore(uint8_t command, uint16_t data);
+
+    bool decodeReply(uint8_t command, const uint8_t *reply, uint16_t *data);
+
+    bool elideWrite(uint8_t command, uint16_t data, bool force);
+
+    void encodeWrite(uint8_t command, uint16_t data, uint8_t *send);
 
     bool i2cWriteThenRead(const uint8_t *write_buffer, size_t write_len, uint8_t *read_buffer, size_t read_len, bool stop = false);
 
     bool i2cWrite(const uint8_t *buffer, size_t len, bool stop = true);
 
+    bool transportStatus(uint8_t code);
+
     bool i2cRead(uint8_t *buffer, size_t len, bool stop = true);
 
     bool _i2cRead(uint8_t *buffer, size_t len, bool stop = true);
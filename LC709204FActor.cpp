@@ -0,0 +1,480 @@
+/**
+ * @file LC709204FActor.cpp
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Thread-safe command queue front end of a LC709204F shared by several tasks
+ * @copyright MIT (see LICENSE.md)
+ */
+
+#include "LC709204FActor.h"
+
+#if defined(ARDUINO_ARCH_ESP32) || defined(LC709204F_HOST_BUILD)
+
+#include <string.h>
+
+enum {
+    REQUEST_FREE = 0,
+    REQUEST_QUEUED = 1,
+    REQUEST_RUNNING = 2,
+};
+
+enum {
+    CALL_FREE = 0,
+    CALL_WAITING = 1,
+    CALL_DONE = 2,
+    CALL_ABANDONED = 3, /// Nobody waits for the result any more, freed on completion
+};
+
+/**
+ * LC709204FActor class
+ *
+ * @param gauge The LC709204F, used by the task running run() only from now on
+ */
+LC709204FActor::LC709204FActor(LC709204F &gauge) : _gauge(gauge) {
+    memset(_requests, 0, sizeof(_requests));
+    memset(_calls, 0, sizeof(_calls));
+    memset(&_stats, 0, sizeof(_stats));
+    _sequence = 0;
+    _stopped = false;
+#if defined(ARDUINO_ARCH_ESP32)
+    _mutex = xSemaphoreCreateMutex();
+    _work = xSemaphoreCreateBinary();
+#endif
+}
+
+LC709204FActor::~LC709204FActor() {
+#if defined(ARDUINO_ARCH_ESP32)
+    vSemaphoreDelete(_work);
+    vSemaphoreDelete(_mutex);
+#endif
+}
+
+/**
+ * Submit Read
+ *
+ * Queues a register read, joining a read of the same register already queued.
+ *
+ * @param command The I2C register/command to read
+ * @param callback Function called with the result, from the owner task
+ * @param context Pointer passed to the callback (optional)
+ * @return False if the queue is full or the actor stopped, the callback is not called then
+ */
+bool LC709204FActor::submitRead(uint8_t command, lc709204f_actor_callback_t callback, void *context) {
+    lock();
+    int8_t call = submit(command, false, 0, callback, context);
+
+    if (call < 0)
+        _stats.rejected++;
+
+    unlock();
+    return call >= 0;
+}
+
+/**
+ * Submit Write
+ *
+ * Queues a register write.
+ *
+ * @param command The I2C register/command to write
+ * @param value 16-bit value to write
+ * @param callback Function called with the result, from the owner task (optional)
+ * @param context Pointer passed to the callback (optional)
+ * @return False if the queue is full or the actor stopped, the callback is not called then
+ */
+bool LC709204FActor::submitWrite(uint8_t command, uint16_t value, lc709204f_actor_callback_t callback, void *context) {
+    lock();
+    int8_t call = submit(command, true, value, callback, context);
+
+    if (call < 0) {
+        _stats.rejected++;
+    } else if (callback == NULL) {
+        // Nobody to hand the result to
+        _calls[call].state = CALL_ABANDONED;
+    }
+
+    unlock();
+    return call >= 0;
+}
+
+/**
+ * Read
+ *
+ * Queues a register read and blocks the calling task until it is done, waiting for room in
+ * the queue first if it is full. Must not be called from the owner task.
+ *
+ * @param command The I2C register/command to read
+ * @param timeout Milliseconds to wait for room in the queue and for the result
+ * @return Register value and status, LC709204F_STATUS_TIMEOUT if the result did not come in
+ *         time, LC709204F_STATUS_BUS_ERROR if the actor stopped
+ */
+lc709204f_result_t LC709204FActor::read(uint8_t command, unsigned long timeout) {
+    lock();
+    lc709204f_result_t result = submitAndWait(command, false, 0, timeout);
+    unlock();
+    return result;
+}
+
+/**
+ * Write
+ *
+ * Queues a register write and blocks the calling task until it is done, waiting for room in
+ * the queue first if it is full. Must not be called from the owner task.
+ *
+ * @param command The I2C register/command to write
+ * @param value 16-bit value to write
+ * @param timeout Milliseconds to wait for room in the queue and for the result
+ * @return Value written and status, see read()
+ */
+lc709204f_result_t LC709204FActor::write(uint8_t command, uint16_t value, unsigned long timeout) {
+    lock();
+    lc709204f_result_t result = submitAndWait(command, true, value, timeout);
+    unlock();
+    return result;
+}
+
+/**
+ * Run
+ *
+ * The owner task loop body: waits for requests, sends everything queued with one
+ * LC709204F::execute() call, then hands out the results.
+ *
+ * @param timeout Milliseconds to wait for a request
+ * @return False once the actor is stopped and the requests queued before are done
+ */
+bool LC709204FActor::run(unsigned long timeout) {
+    lc709204f_batch_item_t items[LC709204F_ACTOR_REQUESTS];
+    uint8_t slots[LC709204F_ACTOR_REQUESTS];
+    lc709204f_actor_call_t callbacks[LC709204F_ACTOR_CALLS];
+    uint8_t n = 0;
+    uint8_t pending = 0;
+
+    lock();
+
+    for (uint8_t i = 0; i < LC709204F_ACTOR_REQUESTS; i++) {
+        if (_requests[i].state == REQUEST_QUEUED)
+            pending++;
+    }
+
+    if (pending == 0 && !_stopped)
+        waitWork(timeout);
+
+    // Queued requests, oldest first
+    for (;;) {
+        int8_t next = -1;
+
+        for (uint8_t i = 0; i < LC709204F_ACTOR_REQUESTS; i++) {
+            if (_requests[i].state == REQUEST_QUEUED && (next < 0 || (int32_t)(_requests[i].sequence - _requests[next].sequence) < 0))
+                next = i;
+        }
+
+        if (next < 0)
+            break;
+
+        lc709204f_actor_request_t &request = _requests[next];
+        request.state = REQUEST_RUNNING;
+        slots[n] = next;
+        items[n].command = request.command;
+        items[n].write = request.write;
+        items[n].value = request.value;
+        n++;
+    }
+
+    bool running = !_stopped;
+
+    if (n) {
+        _stats.executed += n;
+        _stats.batches++;
+    }
+
+    unlock();
+
+    if (n == 0)
+        return running;
+
+    _gauge.execute(items, n);
+
+    uint8_t count = 0;
+
+    lock();
+
+    for (uint8_t i = 0; i < n; i++) {
+        lc709204f_result_t result;
+
+        result.value = items[i].status == LC709204F_STATUS_OK ? items[i].value : 0;
+        result.status = items[i].status;
+        _requests[slots[i]].state = REQUEST_FREE;
+
+        for (uint8_t j = 0; j < LC709204F_ACTOR_CALLS; j++) {
+            lc709204f_actor_call_t &call = _calls[j];
+
+            if (call.state == CALL_FREE || call.request != slots[i])
+                continue;
+
+            if (call.state == CALL_ABANDONED) {
+                call.state = CALL_FREE;
+            } else if (call.callback != NULL) {
+                callbacks[count] = call;
+                callbacks[count++].result = result;
+                call.state = CALL_FREE;
+            } else if (call.state == CALL_WAITING) {
+                call.result = result;
+                call.state = CALL_DONE;
+                signalDone(call);
+            }
+        }
+    }
+
+    signalSpace();
+    unlock();
+
+    // Outside the lock, so that callbacks can submit again
+    for (uint8_t i = 0; i < count; i++) {
+        callbacks[i].callback(callbacks[i].result, callbacks[i].context);
+    }
+
+    return running;
+}
+
+/**
+ * Stop
+ *
+ * Refuses new requests. run() finishes the requests already queued, then returns false.
+ */
+void LC709204FActor::stop(void) {
+    lock();
+    _stopped = true;
+    signalWork();
+    unlock();
+}
+
+/**
+ * Task
+ *
+ * Owner task function, eg: for xTaskCreate() or std::thread: calls run() until stop().
+ *
+ * @param actor The LC709204FActor
+ */
+void LC709204FActor::task(void *actor) {
+    while (((LC709204FActor *) actor)->run(1000)) {
+    }
+
+#if defined(ARDUINO_ARCH_ESP32)
+    vTaskDelete(NULL);
+#endif
+}
+
+/**
+ * Get Stats
+ *
+ * @return Counters since the actor was created
+ */
+lc709204f_actor_stats_t LC709204FActor::getStats(void) {
+    lock();
+    lc709204f_actor_stats_t stats = _stats;
+    unlock();
+    return stats;
+}
+
+/**
+ * Submission helper, with the lock held.
+ *
+ * @return Index of the call, -1 if the queue is full or the actor stopped, not counted as rejected
+ */
+int8_t LC709204FActor::submit(uint8_t command, bool write, uint16_t value, lc709204f_actor_callback_t callback, void *context) {
+    int8_t call = -1;
+    int8_t request = -1;
+
+    for (uint8_t i = 0; i < LC709204F_ACTOR_CALLS && call < 0; i++) {
+        if (_calls[i].state == CALL_FREE)
+            call = i;
+    }
+
+    if (_stopped || call < 0)
+        return -1;
+
+    // Join the newest queued request of the register if it is a read
+    if (!write) {
+        int8_t newest = -1;
+
+        for (uint8_t i = 0; i < LC709204F_ACTOR_REQUESTS; i++) {
+            if (_requests[i].state == REQUEST_QUEUED && _requests[i].command == command &&
+                (newest < 0 || (int32_t)(_requests[i].sequence - _requests[newest].sequence) > 0))
+                newest = i;
+        }
+
+        if (newest >= 0 && !_requests[newest].write) {
+            request = newest;
+            _stats.coalesced++;
+        }
+    }
+
+    if (request < 0) {
+        for (uint8_t i = 0; i < LC709204F_ACTOR_REQUESTS && request < 0; i++) {
+            if (_requests[i].state == REQUEST_FREE)
+                request = i;
+        }
+
+        if (request < 0)
+            return -1;
+
+        lc709204f_actor_request_t &queued = _requests[request];
+        queued.state = REQUEST_QUEUED;
+        queued.command = command;
+        queued.write = write;
+        queued.value = value;
+        queued.sequence = _sequence++;
+        signalWork();
+    }
+
+    lc709204f_actor_call_t &waiting = _calls[call];
+    waiting.state = CALL_WAITING;
+    waiting.request = request;
+    waiting.callback = callback;
+    waiting.context = context;
+#if defined(ARDUINO_ARCH_ESP32)
+    waiting.task = xTaskGetCurrentTaskHandle();
+#endif
+    _stats.submitted++;
+    return call;
+}
+
+/**
+ * Blocking submission helper, with the lock held.
+ */
+lc709204f_result_t LC709204FActor::submitAndWait(uint8_t command, bool write, uint16_t value, unsigned long timeout) {
+    lc709204f_result_t result;
+    unsigned long start = millis();
+    int8_t call;
+
+    result.value = 0;
+    result.status = LC709204F_STATUS_TIMEOUT;
+
+    while ((call = submit(command, write, value, NULL, NULL)) < 0) {
+        unsigned long elapsed = millis() - start;
+
+        if (_stopped) {
+            _stats.rejected++;
+            result.status = LC709204F_STATUS_BUS_ERROR;
+            return result;
+        }
+
+        if (elapsed >= timeout) {
+            _stats.timeouts++;
+            return result;
+        }
+
+        waitSpace(timeout - elapsed);
+    }
+
+    lc709204f_actor_call_t &waiting = _calls[call];
+
+    while (waiting.state == CALL_WAITING) {
+        unsigned long elapsed = millis() - start;
+
+        if (elapsed >= timeout) {
+            // The owner frees the call when the request completes
+            waiting.state = CALL_ABANDONED;
+            _stats.timeouts++;
+            return result;
+        }
+
+        waitDone(waiting, timeout - elapsed);
+    }
+
+    result = waiting.result;
+    waiting.state = CALL_FREE;
+    signalSpace();
+    return result;
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+
+void LC709204FActor::lock(void) {
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+}
+
+void LC709204FActor::unlock(void) {
+    xSemaphoreGive(_mutex);
+}
+
+/**
+ * Waits for signalWork(), with the lock held. The binary semaphore keeps a signal given while
+ * the owner was busy.
+ */
+void LC709204FActor::waitWork(unsigned long timeout) {
+    unlock();
+    xSemaphoreTake(_work, pdMS_TO_TICKS(timeout));
+    lock();
+}
+
+/**
+ * Waits for signalDone(), with the lock held, on notification index 0 of the calling task
+ * (ulTaskNotifyTake()). A notification given before the caller blocks is kept by the task, a
+ * stale one only causes another pass of the submitAndWait() loop.
+ */
+void LC709204FActor::waitDone(lc709204f_actor_call_t &call, unsigned long timeout) {
+    (void) call;
+    unlock();
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeout) + 1);
+    lock();
+}
+
+/**
+ * Waits for room in the queue, with the lock held: no task to notify, it is polled every tick.
+ */
+void LC709204FActor::waitSpace(unsigned long timeout) {
+    (void) timeout;
+    unlock();
+    vTaskDelay(1);
+    lock();
+}
+
+void LC709204FActor::signalWork(void) {
+    xSemaphoreGive(_work);
+}
+
+void LC709204FActor::signalDone(lc709204f_actor_call_t &call) {
+    xTaskNotifyGive(call.task);
+}
+
+void LC709204FActor::signalSpace(void) {}
+
+#else
+
+void LC709204FActor::lock(void) {
+    _mutex.lock();
+}
+
+void LC709204FActor::unlock(void) {
+    _mutex.unlock();
+}
+
+void LC709204FActor::waitWork(unsigned long timeout) {
+    _work.wait_for(_mutex, std::chrono::milliseconds(timeout));
+}
+
+void LC709204FActor::waitDone(lc709204f_actor_call_t &call, unsigned long timeout) {
+    (void) call;
+    _done.wait_for(_mutex, std::chrono::milliseconds(timeout));
+}
+
+void LC709204FActor::waitSpace(unsigned long timeout) {
+    _done.wait_for(_mutex, std::chrono::milliseconds(timeout));
+}
+
+void LC709204FActor::signalWork(void) {
+    _work.notify_one();
+}
+
+void LC709204FActor::signalDone(lc709204f_actor_call_t &call) {
+    (void) call;
+    _done.notify_all();
+}
+
+void LC709204FActor::signalSpace(void) {
+    _done.notify_all();
+}
+
+#endif
+
+#endif
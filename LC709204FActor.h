@@ -0,0 +1,176 @@
+/**
+ * @file LC709204FActor.h
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Thread-safe command queue front end of a LC709204F shared by several tasks
+ * @copyright MIT (see LICENSE.md)
+ */
+
+#ifndef _LC709204F_ACTOR_H
+#define _LC709204F_ACTOR_H
+
+#include "LC709204F.h"
+
+#if defined(ARDUINO_ARCH_ESP32) || defined(LC709204F_HOST_BUILD)
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+#ifndef LC709204F_ACTOR_REQUESTS
+#define LC709204F_ACTOR_REQUESTS 8 /// Register reads and writes queued at once.
+#endif
+
+#ifndef LC709204F_ACTOR_CALLS
+#define LC709204F_ACTOR_CALLS 16 /// Callers (blocked or with a callback) waiting for results at once.
+#endif
+
+static_assert(LC709204F_ACTOR_REQUESTS <= 127 && LC709204F_ACTOR_CALLS <= 127, "LC709204FActor slots are indexed with int8_t");
+
+/**
+ * Actor completion callback, called from the task running LC709204FActor::run()
+ *
+ * @param result Value read or written, and status of the transfer
+ * @param context The context pointer passed at submission
+ */
+typedef void (*lc709204f_actor_callback_t)(lc709204f_result_t result, void *context);
+
+/**
+ * Actor counters
+ */
+typedef struct {
+    uint32_t submitted; /// Reads and writes accepted
+    uint32_t coalesced; /// Reads answered by a read of the same register already queued
+    uint32_t executed;  /// Reads and writes handed to the driver
+    uint32_t batches;   /// LC709204F::execute() calls
+    uint32_t rejected;  /// Submissions refused: queue full (submitRead/submitWrite) or actor stopped
+    uint32_t timeouts;  /// Blocking calls that gave up waiting for room or for the result
+} lc709204f_actor_stats_t;
+
+/**
+ * Queued register read or write of a LC709204FActor
+ */
+typedef struct {
+    uint8_t state;     /// Free, queued or running
+    uint8_t command;   /// Register
+    bool write;        /// Write instead of read
+    uint16_t value;    /// Value to write
+    uint32_t sequence; /// Submission order
+} lc709204f_actor_request_t;
+
+/**
+ * Caller waiting for a LC709204FActor request
+ */
+typedef struct {
+    uint8_t state;                       /// Free, waiting, done or abandoned
+    int8_t request;                      /// Index of the request
+    lc709204f_actor_callback_t callback; /// NULL for a blocked caller
+    void *context;                       /// Passed to the callback
+    lc709204f_result_t result;           /// Set when done
+#if defined(ARDUINO_ARCH_ESP32)
+    TaskHandle_t task;                   /// Blocked caller, notified when done
+#endif
+} lc709204f_actor_call_t;
+
+/**
+ * Single owner command queue in front of a LC709204F
+ *
+ * The LC709204F is not reentrant: two tasks calling it at once interleave the command write
+ * and the reply read of their transfers. The actor makes one task the only user of the driver;
+ * the other tasks, on any core, post reads and writes to it and get the results through a
+ * callback or by blocking until they are done.
+ *
+ * A read of a register which is already queued, and not yet sent, joins that read: N tasks
+ * reading RSOC at the same time cause one bus read. Requests run in submission order, so a
+ * read never joins one queued before a write of the same register. Everything queued when the
+ * owner task wakes up is sent with one LC709204F::execute() call.
+ *
+ *   LC709204FActor actor(batteryMonitor);
+ *   xTaskCreatePinnedToCore(LC709204FActor::task, "gauge", 4096, &actor, 5, NULL, 0);
+ *   ...
+ *   lc709204f_result_t rsoc = actor.read(LC709204F_REG_RSOC, 100); // from any task
+ *
+ * Once the actor runs, only the owner task may call the LC709204F directly. Callbacks run in the
+ * owner task: they must not block on the actor. A blocked caller also waits for room in a full
+ * queue, within the same timeout.
+ *
+ * On ESP32 a blocked caller waits with ulTaskNotifyTake() on notification index 0 of its own
+ * task: that task must not use index 0 for anything else. On a host build (LC709204F_HOST_BUILD)
+ * std::mutex and condition variables are used, the owner being eg: a std::thread running task().
+ */
+class LC709204FActor {
+public:
+    LC709204FActor(LC709204F &gauge);
+
+    ~LC709204FActor();
+
+    bool submitRead(uint8_t command, lc709204f_actor_callback_t callback, void *context = NULL);
+
+    bool submitWrite(uint8_t command, uint16_t value, lc709204f_actor_callback_t callback = NULL, void *context = NULL);
+
+    lc709204f_result_t read(uint8_t command, unsigned long timeout);
+
+    lc709204f_result_t write(uint8_t command, uint16_t value, unsigned long timeout);
+
+    bool run(unsigned long timeout);
+
+    void stop(void);
+
+    static void task(void *actor);
+
+    lc709204f_actor_stats_t getStats(void);
+
+private:
+    LC709204F &_gauge;
+
+    lc709204f_actor_request_t _requests[LC709204F_ACTOR_REQUESTS];
+
+    lc709204f_actor_call_t _calls[LC709204F_ACTOR_CALLS];
+
+    uint32_t _sequence;
+
+    bool _stopped;
+
+    lc709204f_actor_stats_t _stats;
+
+#if defined(ARDUINO_ARCH_ESP32)
+    SemaphoreHandle_t _mutex;
+
+    SemaphoreHandle_t _work;
+#else
+    std::mutex _mutex;
+
+    std::condition_variable_any _work;
+
+    std::condition_variable_any _done;
+#endif
+
+    int8_t submit(uint8_t command, bool write, uint16_t value, lc709204f_actor_callback_t callback, void *context);
+
+    lc709204f_result_t submitAndWait(uint8_t command, bool write, uint16_t value, unsigned long timeout);
+
+    void lock(void);
+
+    void unlock(void);
+
+    void waitWork(unsigned long timeout);
+
+    void waitDone(lc709204f_actor_call_t &call, unsigned long timeout);
+
+    void waitSpace(unsigned long timeout);
+
+    void signalWork(void);
+
+    void signalDone(lc709204f_actor_call_t &call);
+
+    void signalSpace(void);
+};
+
+#endif
+
+#endif
@@ -0,0 +1,160 @@
+/**
+ * @file LC709204FAlarm.cpp
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Interrupt driven LC709204F alarm monitoring through the ALARMB pin
+ * @copyright MIT (see LICENSE.md)
+ */
+
+#include "LC709204FAlarm.h"
+
+LC709204FAlarm *LC709204FAlarm::_instance = NULL;
+
+/**
+ * LC709204FAlarm class
+ *
+ * @param gauge The LC709204F whose ALARMB pin is monitored
+ */
+LC709204FAlarm::LC709204FAlarm(LC709204F &gauge) : _gauge(gauge) {
+    _pin = 0xFF;
+    _callback = NULL;
+    _context = NULL;
+    _pending = false;
+    _interrupts = 0;
+    _alarms = 0;
+    _holdoff = LC709204F_ALARM_HOLDOFF;
+    _checkedAt = 0;
+}
+
+/**
+ * Begin
+ *
+ * Attaches the interrupt to the ALARMB pin. Only one LC709204FAlarm can be attached at a time;
+ * for more gauges, call trigger() from your own interrupt handlers instead.
+ * The first update() reads BatteryStatus once, to catch alarms and resets that happened before.
+ *
+ * @param pin The GPIO connected to ALARMB, the internal pull-up is enabled
+ * @param callback Function called by update() when alarms fired
+ * @param context Pointer passed back to the callback
+ * @return False if the pin has no interrupt or another LC709204FAlarm is attached
+ */
+bool LC709204FAlarm::begin(uint8_t pin, lc709204f_alarm_callback_t callback, void *context) {
+    int interrupt = digitalPinToInterrupt(pin);
+
+    if (interrupt < 0 || (_instance != NULL && _instance != this))
+        return false;
+
+    _pin = pin;
+    _callback = callback;
+    _context = context;
+    _pending = true;
+    _instance = this;
+
+    pinMode(pin, INPUT_PULLUP);
+    attachInterrupt(interrupt, isr, FALLING);
+    return true;
+}
+
+/**
+ * End
+ *
+ * Detaches the interrupt.
+ */
+void LC709204FAlarm::end(void) {
+    if (_pin != 0xFF)
+        detachInterrupt(digitalPinToInterrupt(_pin));
+
+    if (_instance == this)
+        _instance = NULL;
+
+    _pin = 0xFF;
+}
+
+/**
+ * Update
+ *
+ * Call from loop() or a task. Does nothing unless ALARMB fired; then reads BatteryStatus,
+ * clears the alarm bits that are set and calls the callback. If ALARMB is still LOW
+ * afterwards (the alarm condition persists), it is checked again after the holdoff.
+ *
+ * @return True if BatteryStatus was read
+ */
+bool LC709204FAlarm::update(void) {
+    if (!_pending) {
+        if (_pin == 0xFF || digitalRead(_pin) != LOW || millis() - _checkedAt < _holdoff)
+            return false;
+    }
+
+    _pending = false;
+    _checkedAt = millis();
+
+    lc709204f_result_t status = _gauge.readBatteryStatus();
+
+    if (status.status != LC709204F_STATUS_OK) {
+        // Try again at the next update
+        _pending = true;
+        return true;
+    }
+
+    _alarms = status.value & (LC709204F_BATTERY_STATUS_ALARMS | LC709204F_BATTERY_STATUS_INITIALIZED);
+
+    // Alarm bits are cleared by writing them 0, which releases ALARMB.
+    // The initialized bit is left for init() to clear.
+    if ((_alarms & LC709204F_BATTERY_STATUS_ALARMS) && !_gauge.setBatteryStatus(status.value & ~LC709204F_BATTERY_STATUS_ALARMS))
+        _pending = true;
+
+    if (_alarms && _callback != NULL)
+        _callback(_alarms, status.value, _context);
+
+    return true;
+}
+
+/**
+ * Trigger
+ *
+ * Flags an ALARMB event, for the next update() to handle. Safe to call from an interrupt handler.
+ */
+void LC709204F_ISR_ATTR LC709204FAlarm::trigger(void) {
+    _pending = true;
+    _interrupts = _interrupts + 1;
+}
+
+/**
+ * Set Holdoff
+ *
+ * @param holdoff Time in ms before a persisting alarm (ALARMB still LOW) is read again
+ */
+void LC709204FAlarm::setHoldoff(unsigned long holdoff) {
+    _holdoff = holdoff;
+}
+
+/**
+ * Get Alarms
+ *
+ * @return Alarm bits (and LC709204F_BATTERY_STATUS_INITIALIZED) found by the last BatteryStatus read
+ */
+uint16_t LC709204FAlarm::getAlarms(void) {
+    return _alarms;
+}
+
+/**
+ * Get Interrupts
+ *
+ * Call from loop() or a task, not from an interrupt handler: interrupts are enabled again on return.
+ *
+ * @return Number of ALARMB events flagged
+ */
+uint32_t LC709204FAlarm::getInterrupts(void) {
+    uint32_t count;
+
+    // The ISR may increment the counter between the bytes of the read on 8-bit MCUs
+    noInterrupts();
+    count = _interrupts;
+    interrupts();
+    return count;
+}
+
+void LC709204F_ISR_ATTR LC709204FAlarm::isr(void) {
+    if (_instance != NULL)
+        _instance->trigger();
+}
@@ -0,0 +1,87 @@
+/**
+ * @file LC709204FAlarm.h
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Interrupt driven LC709204F alarm monitoring through the ALARMB pin
+ * @copyright MIT (see LICENSE.md)
+ */
+
+#ifndef _LC709204F_ALARM_H
+#define _LC709204F_ALARM_H
+
+#include "LC709204F.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#define LC709204F_ISR_ATTR IRAM_ATTR
+#else
+#define LC709204F_ISR_ATTR
+#endif
+
+#define LC709204F_ALARM_HOLDOFF 1000 /// Default ms before ALARMB still being LOW is checked again
+
+/**
+ * Alarm callback
+ *
+ * @param alarms The LC709204F_BATTERY_STATUS_* alarm bits that fired, plus
+ *               LC709204F_BATTERY_STATUS_INITIALIZED after a power on reset (call init() then)
+ * @param status The BatteryStatus value read
+ * @param context The context pointer passed to begin
+ */
+typedef void (*lc709204f_alarm_callback_t)(uint16_t alarms, uint16_t status, void *context);
+
+/**
+ * Interrupt driven alarm monitoring
+ *
+ * ALARMB is an open drain output the LC709204F pulls LOW while an alarm bit of BatteryStatus
+ * is set. The interrupt only flags the event; update(), called from loop() or a task, reads
+ * BatteryStatus, clears the alarm bits that fired and calls the callback. Nothing is read
+ * from the bus while ALARMB stays HIGH.
+ *
+ *   LC709204FAlarm alarm(batteryMonitor);
+ *   alarm.begin(ALARMB_PIN, onAlarm);
+ *   ...
+ *   alarm.update(); // in loop()
+ */
+class LC709204FAlarm {
+public:
+    LC709204FAlarm(LC709204F &gauge);
+
+    bool begin(uint8_t pin, lc709204f_alarm_callback_t callback, void *context = NULL);
+
+    void end(void);
+
+    bool update(void);
+
+    void trigger(void);
+
+    void setHoldoff(unsigned long holdoff);
+
+    uint16_t getAlarms(void);
+
+    uint32_t getInterrupts(void);
+
+private:
+    LC709204F &_gauge;
+
+    uint8_t _pin;
+
+    lc709204f_alarm_callback_t _callback;
+
+    void *_context;
+
+    volatile bool _pending;
+
+    volatile uint32_t _interrupts;
+
+    uint16_t _alarms;
+
+    unsigned long _holdoff;
+
+    unsigned long _checkedAt;
+
+    static LC709204FAlarm *_instance;
+
+    static void LC709204F_ISR_ATTR isr(void);
+};
+
+#endif
@@ -0,0 +1,102 @@
+/**
+ * @file LC709204FBatch.cpp
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Batched LC709204F register reads and writes, executed as one submission
+ * @copyright MIT (see LICENSE.md)
+ */
+
+#include "LC709204FBatch.h"
+
+/**
+ * LC709204FBatch class
+ */
+LC709204FBatch::LC709204FBatch(void) {
+    clear();
+}
+
+/**
+ * Read
+ *
+ * @param command The I2C register/command to read
+ * @return Index of the item, -1 if the batch is full
+ */
+int8_t LC709204FBatch::read(uint8_t command) {
+    return add(command, false, 0);
+}
+
+/**
+ * Write
+ *
+ * @param command The I2C register/command to write
+ * @param value 16-bit value to write
+ * @return Index of the item, -1 if the batch is full
+ */
+int8_t LC709204FBatch::write(uint8_t command, uint16_t value) {
+    return add(command, true, value);
+}
+
+/**
+ * Execute
+ *
+ * Performs the queued items in order, see LC709204F::execute().
+ *
+ * @param gauge The LC709204F to access
+ * @return True if every item succeeded
+ */
+bool LC709204FBatch::execute(LC709204F &gauge) {
+    return gauge.execute(_items, _count);
+}
+
+/**
+ * Get Result
+ *
+ * @param index Index returned by read() or write()
+ * @return Value read (or written) and status of the item after the last execute()
+ */
+lc709204f_result_t LC709204FBatch::getResult(int8_t index) {
+    lc709204f_result_t result;
+
+    if (index < 0 || index >= _count) {
+        result.value = 0;
+        result.status = LC709204F_STATUS_BUS_ERROR;
+    } else {
+        result.value = _items[index].value;
+        result.status = _items[index].status;
+    }
+    return result;
+}
+
+/**
+ * Get Items
+ *
+ * @return The queued items, size() of them
+ */
+const lc709204f_batch_item_t *LC709204FBatch::getItems(void) {
+    return _items;
+}
+
+uint8_t LC709204FBatch::size(void) {
+    return _count;
+}
+
+/**
+ * Clear
+ *
+ * Removes all the items.
+ */
+void LC709204FBatch::clear(void) {
+    _count = 0;
+}
+
+int8_t LC709204FBatch::add(uint8_t command, bool write, uint16_t value) {
+    if (_count >= LC709204F_BATCH_SIZE)
+        return -1;
+
+    lc709204f_batch_item_t &item = _items[_count];
+    item.command = command;
+    item.write = write;
+    item.value = value;
+    item.status = LC709204F_STATUS_OK;
+    return _count++;
+}
@@ -0,0 +1,58 @@
+/**
+ * @file LC709204FBatch.h
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Batched LC709204F register reads and writes, executed as one submission
+ * @copyright MIT (see LICENSE.md)
+ */
+
+#ifndef _LC709204F_BATCH_H
+#define _LC709204F_BATCH_H
+
+#include "LC709204F.h"
+
+#ifndef LC709204F_BATCH_SIZE
+#define LC709204F_BATCH_SIZE 16 /// Number of items a LC709204FBatch can hold.
+#endif
+
+/**
+ * Batch builder
+ *
+ * Queue register reads and writes, execute them with one driver call, then read the
+ * per-item results. Reads are CRC checked; the items stay queued, so the same batch can
+ * be executed again, eg: for a periodic telemetry sweep.
+ *
+ *   LC709204FBatch batch;
+ *   int8_t voltage = batch.read(LC709204F_REG_CELL_VOLTAGE);
+ *   int8_t rsoc = batch.read(LC709204F_REG_RSOC);
+ *   batch.write(LC709204F_REG_ALARM_LOW_RSOC, 10);
+ *   batch.execute(batteryMonitor);
+ *   lc709204f_result_t result = batch.getResult(voltage);
+ */
+class LC709204FBatch {
+public:
+    LC709204FBatch(void);
+
+    int8_t read(uint8_t command);
+
+    int8_t write(uint8_t command, uint16_t value);
+
+    bool execute(LC709204F &gauge);
+
+    lc709204f_result_t getResult(int8_t index);
+
+    const lc709204f_batch_item_t *getItems(void);
+
+    uint8_t size(void);
+
+    void clear(void);
+
+private:
+    lc709204f_batch_item_t _items[LC709204F_BATCH_SIZE];
+
+    uint8_t _count;
+
+    int8_t add(uint8_t command, bool write, uint16_t value);
+};
+
+#endif
@@ -0,0 +1,254 @@
+/**
+ * @file LC709204FConfig.cpp
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details LC709204F configuration profile: serialize, apply the differences, verify
+ * @copyright MIT (see LICENSE.md)
+ */
+
+#include "LC709204FConfig.h"
+
+static_assert(LC709204F_CONFIG_SIZE <= 16, "LC709204F_CONFIG_SIZE must fit the uint16_t masks");
+static_assert(LC709204F_CONFIG_BLOB_SIZE == 3 + 2 * LC709204F_CONFIG_SIZE, "LC709204F_CONFIG_BLOB_SIZE does not match the format");
+
+/**
+ * Configuration registers, in field (and write) order.
+ */
+static const struct {
+    uint8_t command;
+    uint16_t LC709204FConfig::*field;
+} LC709204F_CONFIG_REGISTERS[LC709204F_CONFIG_SIZE] = {
+    {LC709204F_REG_APA, &LC709204FConfig::apa},
+    {LC709204F_REG_CHANGE_OF_THE_PARAMETER, &LC709204FConfig::changeOfTheParameter},
+    {LC709204F_REG_STATUS_BIT, &LC709204FConfig::statusBit},
+    {LC709204F_REG_TSENSE1_THERMISTOR_B, &LC709204FConfig::tsense1ThermistorB},
+    {LC709204F_REG_TSENSE2_THERMISTOR_B, &LC709204FConfig::tsense2ThermistorB},
+    {LC709204F_REG_APT, &LC709204FConfig::apt},
+    {LC709204F_REG_CURRENT_DIRECTION, &LC709204FConfig::currentDirection},
+    {LC709204F_REG_TERMINATION_CURRENT_RATE, &LC709204FConfig::terminationCurrentRate},
+    {LC709204F_REG_EMPTY_CELL_VOLTAGE, &LC709204FConfig::emptyCellVoltage},
+    {LC709204F_REG_ITE_OFFSET, &LC709204FConfig::iteOffset},
+    {LC709204F_REG_ALARM_LOW_RSOC, &LC709204FConfig::alarmLowRSOC},
+    {LC709204F_REG_ALARM_LOW_CELL_VOLTAGE, &LC709204FConfig::alarmLowCellVoltage},
+    {LC709204F_REG_ALARM_HIGH_CELL_VOLTAGE, &LC709204FConfig::alarmHighCellVoltage},
+    {LC709204F_REG_ALARM_LOW_TEMPERATURE, &LC709204FConfig::alarmLowTemperature},
+    {LC709204F_REG_ALARM_HIGH_TEMPERATURE, &LC709204FConfig::alarmHighTemperature},
+    {LC709204F_REG_IC_POWER_MODE, &LC709204FConfig::icPowerMode},
+};
+
+/**
+ * Bitwise CRC8 (polynomial 0x07) protecting the serialized profile.
+ */
+static uint8_t configCrc8(const uint8_t *data, size_t len) {
+    uint8_t crc(0x00);
+
+    for (size_t j = len; j; --j) {
+        crc ^= *data++;
+
+        for (int i = 8; i; --i) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+/**
+ * LC709204FConfig class
+ *
+ * Starts from the power on reset values of the datasheet.
+ */
+LC709204FConfig::LC709204FConfig(void) {
+    apa = 0x0000;
+    changeOfTheParameter = LC709204F_BATTERY_PROFILE_3_7_V;
+    statusBit = 0x0000;
+    tsense1ThermistorB = 0x0D34;
+    tsense2ThermistorB = 0x0D34;
+    apt = 0x001E;
+    currentDirection = LC709204F_CURRENT_DIRECTION_AUTO_MODE;
+    terminationCurrentRate = 0x0002;
+    emptyCellVoltage = 0x0000;
+    iteOffset = 0x0000;
+    alarmLowRSOC = 0x0000;
+    alarmLowCellVoltage = 0x0000;
+    alarmHighCellVoltage = 0x0000;
+    alarmLowTemperature = 0x0000;
+    alarmHighTemperature = 0x0000;
+    icPowerMode = LC709204F_POWER_MODE_SLEEP;
+}
+
+/**
+ * Read
+ *
+ * Loads the configuration the LC709204F currently holds. With the shadow register file
+ * enabled, registers already known are not read from the bus.
+ *
+ * @param gauge The LC709204F to read from
+ * @return True if all registers were read, the fields that could not be read are unchanged
+ */
+bool LC709204FConfig::read(LC709204F &gauge) {
+    bool success = true;
+
+    for (uint8_t i = 0; i < LC709204F_CONFIG_SIZE; i++) {
+        lc709204f_result_t result = gauge.readRegister(LC709204F_CONFIG_REGISTERS[i].command);
+
+        if (result.status == LC709204F_STATUS_OK) {
+            this->*LC709204F_CONFIG_REGISTERS[i].field = result.value;
+        } else {
+            success = false;
+        }
+    }
+    return success;
+}
+
+/**
+ * Apply
+ *
+ * Reads the current configuration once, then writes the registers that differ in field order.
+ * Registers that could not be read are written. Stops at the first failed write, like init().
+ *
+ * @param gauge The LC709204F to configure
+ * @param written Optional, mask of the registers written
+ * @return True if the LC709204F holds this configuration
+ */
+bool LC709204FConfig::apply(LC709204F &gauge, uint16_t *written) {
+    LC709204FConfig current;
+    uint16_t unknown = 0;
+
+    for (uint8_t i = 0; i < LC709204F_CONFIG_SIZE; i++) {
+        lc709204f_result_t result = gauge.readRegister(LC709204F_CONFIG_REGISTERS[i].command);
+
+        if (result.status == LC709204F_STATUS_OK) {
+            current.*LC709204F_CONFIG_REGISTERS[i].field = result.value;
+        } else {
+            unknown |= 1 << i;
+        }
+    }
+
+    uint16_t changes = diff(current) | unknown;
+
+    if (written != NULL)
+        *written = 0;
+
+    for (uint8_t i = 0; i < LC709204F_CONFIG_SIZE; i++) {
+        if (!(changes & (1 << i)))
+            continue;
+
+        if (!gauge.writeRegister(LC709204F_CONFIG_REGISTERS[i].command, this->*LC709204F_CONFIG_REGISTERS[i].field))
+            return false;
+
+        if (written != NULL)
+            *written |= 1 << i;
+    }
+    return true;
+}
+
+/**
+ * Verify
+ *
+ * Reads every configuration register back from the bus, in a single pass, and compares it
+ * with this configuration. The shadow register file is invalidated first so the values are
+ * the ones the LC709204F holds; the reads refill it.
+ *
+ * @param gauge The LC709204F to check
+ * @param mismatch Optional, mask of the registers that differ or could not be read
+ * @return True if the LC709204F holds this configuration
+ */
+bool LC709204FConfig::verify(LC709204F &gauge, uint16_t *mismatch) {
+    LC709204FConfig current = *this;
+    uint16_t unknown = 0;
+
+    gauge.invalidateShadow();
+
+    for (uint8_t i = 0; i < LC709204F_CONFIG_SIZE; i++) {
+        lc709204f_result_t result = gauge.readRegister(LC709204F_CONFIG_REGISTERS[i].command);
+
+        if (result.status == LC709204F_STATUS_OK) {
+            current.*LC709204F_CONFIG_REGISTERS[i].field = result.value;
+        } else {
+            unknown |= 1 << i;
+        }
+    }
+
+    uint16_t differences = diff(current) | unknown;
+
+    if (mismatch != NULL)
+        *mismatch = differences;
+
+    return differences == 0;
+}
+
+/**
+ * Diff
+ *
+ * @param other Configuration to compare with
+ * @return Mask of the registers whose values differ
+ */
+uint16_t LC709204FConfig::diff(const LC709204FConfig &other) const {
+    uint16_t differences = 0;
+
+    for (uint8_t i = 0; i < LC709204F_CONFIG_SIZE; i++) {
+        if (this->*LC709204F_CONFIG_REGISTERS[i].field != other.*LC709204F_CONFIG_REGISTERS[i].field)
+            differences |= 1 << i;
+    }
+    return differences;
+}
+
+/**
+ * Serialize
+ *
+ * Format: version, register count, the registers in field order as little endian 16-bit
+ * values, CRC8 of all the previous bytes. Suitable for EEPROM, flash or a provisioning link.
+ *
+ * @param buffer Destination
+ * @param size Size of the destination, at least LC709204F_CONFIG_BLOB_SIZE
+ * @return Number of bytes written, 0 if the buffer is too small
+ */
+size_t LC709204FConfig::serialize(uint8_t *buffer, size_t size) const {
+    if (size < LC709204F_CONFIG_BLOB_SIZE)
+        return 0;
+
+    uint8_t *p = buffer;
+    *p++ = LC709204F_CONFIG_VERSION;
+    *p++ = LC709204F_CONFIG_SIZE;
+
+    for (uint8_t i = 0; i < LC709204F_CONFIG_SIZE; i++) {
+        uint16_t value = this->*LC709204F_CONFIG_REGISTERS[i].field;
+        *p++ = value & 0xFF;
+        *p++ = value >> 8;
+    }
+
+    *p = configCrc8(buffer, p - buffer);
+    return LC709204F_CONFIG_BLOB_SIZE;
+}
+
+/**
+ * Deserialize
+ *
+ * @param buffer Data produced by serialize()
+ * @param len Number of bytes available
+ * @return False if the data is truncated, corrupt or of another version; the configuration is then unchanged
+ */
+bool LC709204FConfig::deserialize(const uint8_t *buffer, size_t len) {
+    if (len < LC709204F_CONFIG_BLOB_SIZE || buffer[0] != LC709204F_CONFIG_VERSION || buffer[1] != LC709204F_CONFIG_SIZE)
+        return false;
+
+    if (configCrc8(buffer, LC709204F_CONFIG_BLOB_SIZE - 1) != buffer[LC709204F_CONFIG_BLOB_SIZE - 1])
+        return false;
+
+    const uint8_t *p = buffer + 2;
+
+    for (uint8_t i = 0; i < LC709204F_CONFIG_SIZE; i++, p += 2) {
+        this->*LC709204F_CONFIG_REGISTERS[i].field = p[0] | (p[1] << 8);
+    }
+    return true;
+}
+
+/**
+ * Get Command
+ *
+ * @param index Field index, the bit number in the masks
+ * @return Command code of the register, 0 if the index is out of range
+ */
+uint8_t LC709204FConfig::getCommand(uint8_t index) {
+    return index < LC709204F_CONFIG_SIZE ? LC709204F_CONFIG_REGISTERS[index].command : 0;
+}
@@ -0,0 +1,71 @@
+/**
+ * @file LC709204FConfig.h
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details LC709204F configuration profile: serialize, apply the differences, verify
+ * @copyright MIT (see LICENSE.md)
+ */
+
+#ifndef _LC709204F_CONFIG_H
+#define _LC709204F_CONFIG_H
+
+#include "LC709204F.h"
+
+#define LC709204F_CONFIG_SIZE 16         /// Number of configuration registers in a LC709204FConfig.
+#define LC709204F_CONFIG_ALL 0xFFFF      /// Mask of all the configuration registers.
+#define LC709204F_CONFIG_VERSION 1       /// Serialized format version.
+#define LC709204F_CONFIG_BLOB_SIZE 35    /// Serialized size: version, count, 2 bytes per register, CRC8.
+
+/**
+ * Configuration profile
+ *
+ * Holds every R/W configuration register of the LC709204F, in register units. The fields are
+ * declared in the order apply() writes them: battery model first, then measurement setup, then
+ * alarm thresholds, and the power mode last so the gauge starts measuring fully configured.
+ * Bit n of the masks used below stands for the n-th field.
+ *
+ *   LC709204FConfig config;                            // power on reset values
+ *   config.apa = LC709204F_APA_1000MAH;
+ *   config.changeOfTheParameter = LC709204F_BATTERY_PROFILE_3_7_V;
+ *   config.alarmLowRSOC = 10;
+ *   config.icPowerMode = LC709204F_POWER_MODE_OPERATE;
+ *   config.apply(batteryMonitor);                      // writes only what differs
+ *   config.verify(batteryMonitor);
+ */
+class LC709204FConfig {
+public:
+    uint16_t apa;                    /// APA (0x0B), lc709204f_apa_adjustment_t
+    uint16_t changeOfTheParameter;   /// ChangeOfTheParameter (0x12), lc709204f_battery_profile_t
+    uint16_t statusBit;              /// StatusBit (0x16), thermistor mode
+    uint16_t tsense1ThermistorB;     /// TSENSE1ThermistorB (0x06), K
+    uint16_t tsense2ThermistorB;     /// TSENSE2ThermistorB (0x0E), K
+    uint16_t apt;                    /// APT (0x0C)
+    uint16_t currentDirection;       /// CurrentDirection (0x0A), lc709204f_current_direction_t
+    uint16_t terminationCurrentRate; /// TerminationCurrentRate (0x1C), 0.01C
+    uint16_t emptyCellVoltage;       /// EmptyCellVoltage (0x1D), mV
+    uint16_t iteOffset;              /// ITEOffset (0x1E), 0.1%
+    uint16_t alarmLowRSOC;           /// AlarmLowRSOC (0x13), %, 0 disables
+    uint16_t alarmLowCellVoltage;    /// AlarmLowCellVoltage (0x14), mV, 0 disables
+    uint16_t alarmHighCellVoltage;   /// AlarmHighCellVoltage (0x1F), mV, 0 disables
+    uint16_t alarmLowTemperature;    /// AlarmLowTemperature (0x20), 0.1K, 0 disables
+    uint16_t alarmHighTemperature;   /// AlarmHighTemperature (0x21), 0.1K, 0 disables
+    uint16_t icPowerMode;            /// ICPowerMode (0x15), lc709204f_power_mode_t
+
+    LC709204FConfig(void);
+
+    bool read(LC709204F &gauge);
+
+    bool apply(LC709204F &gauge, uint16_t *written = NULL);
+
+    bool verify(LC709204F &gauge, uint16_t *mismatch = NULL);
+
+    uint16_t diff(const LC709204FConfig &other) const;
+
+    size_t serialize(uint8_t *buffer, size_t size) const;
+
+    bool deserialize(const uint8_t *buffer, size_t len);
+
+    static uint8_t getCommand(uint8_t index);
+};
+
+#endif
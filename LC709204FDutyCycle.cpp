@@ -0,0 +1,244 @@
+/**
+ * @file LC709204FDutyCycle.cpp
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Duty cycled LC709204F acquisition: wake, settle, read, sleep
+ * @copyright MIT (see LICENSE.md)
+ */
+
+#include "LC709204FDutyCycle.h"
+
+/**
+ * LC709204FDutyCycle class
+ *
+ * @param gauge The LC709204F to acquire from
+ * @param period Time between acquisitions, in ms
+ * @param settle Time between the wake up and the read, in ms, for the measurements to be refreshed
+ * @param fields Mask of lc709204f_snapshot_field_t values to read (default LC709204F_FIELD_ALL)
+ */
+LC709204FDutyCycle::LC709204FDutyCycle(LC709204F &gauge, unsigned long period, unsigned long settle, uint16_t fields) : _gauge(gauge) {
+    _period = period;
+    _settle = settle;
+    _fields = fields;
+    _state = LC709204F_DUTY_SLEEPING;
+    _due = millis();
+    _wokeAt = 0;
+    _frequency = 100000;
+    _operateCurrent = LC709204F_OPERATE_CURRENT;
+    _sleepCurrent = LC709204F_SLEEP_CURRENT;
+    _snapshot.valid = 0;
+    resetStats();
+}
+
+/**
+ * Begin
+ *
+ * Puts the gauge to sleep, the first acquisition is due immediately. If the sleep write fails
+ * the gauge is still woken up by the first acquisition, which then waits for the settle time.
+ *
+ * @return True on I2C command success
+ */
+bool LC709204FDutyCycle::begin(void) {
+    // Operational until the sleep write succeeds, for the time accounting
+    _state = LC709204F_DUTY_SETTLING;
+    _due = millis();
+
+    if (setMode(LC709204F_POWER_MODE_SLEEP))
+        return true;
+
+    accountMode(millis());
+    _state = LC709204F_DUTY_SLEEPING;
+    return false;
+}
+
+/**
+ * Run
+ *
+ * Call from loop() or a task. Wakes the gauge up when the period elapsed, and once the settle
+ * time elapsed reads the snapshot and puts the gauge back to sleep. Periods missed entirely
+ * are skipped, not caught up with.
+ *
+ * @return True when an acquisition completed, see getSnapshot()
+ */
+bool LC709204FDutyCycle::run(void) {
+    unsigned long now = millis();
+
+    if (_state == LC709204F_DUTY_SLEEPING) {
+        if ((long)(now - _due) < 0)
+            return false;
+
+        _due += _period;
+        if ((long)(now - _due) >= 0)
+            _due = now + _period;
+
+        if (!setMode(LC709204F_POWER_MODE_OPERATE)) {
+            _stats.failures++;
+            return false;
+        }
+
+        _wokeAt = now;
+    }
+
+    if (now - _wokeAt < _settle)
+        return false;
+
+    uint32_t issued = _gauge.getIssuedReads();
+    bool complete = _gauge.readSnapshot(_snapshot, _fields);
+
+    _busBits += (_gauge.getIssuedReads() - issued) * LC709204F_READ_BITS;
+
+    unsigned long latency = millis() - _wokeAt;
+
+    if (!setMode(LC709204F_POWER_MODE_SLEEP)) {
+        // Left operational, the next wake up write will be elided or harmless
+        accountMode(millis());
+        _state = LC709204F_DUTY_SLEEPING;
+        complete = false;
+    }
+
+    _stats.cycles++;
+
+    if (complete) {
+        _stats.lastLatency = latency;
+        if (latency > _stats.maxLatency)
+            _stats.maxLatency = latency;
+    } else {
+        _stats.failures++;
+    }
+
+    return true;
+}
+
+/**
+ * Acquire
+ *
+ * Blocking acquisition: wakes the gauge now, waits for the settle time, reads and puts the
+ * gauge back to sleep. The next periodic acquisition is one period later.
+ *
+ * @return True if all fields were read
+ */
+bool LC709204FDutyCycle::acquire(void) {
+    if (_state == LC709204F_DUTY_SLEEPING)
+        _due = millis();
+
+    for (;;) {
+        if (run())
+            return (_snapshot.valid & _fields) == _fields;
+
+        // Wake up write failed
+        if (_state == LC709204F_DUTY_SLEEPING)
+            return false;
+
+        delay(getIdleTime());
+    }
+}
+
+/**
+ * Get Snapshot
+ *
+ * @return The snapshot of the last acquisition, see snapshot.valid
+ */
+const lc709204f_battery_snapshot_t &LC709204FDutyCycle::getSnapshot(void) {
+    return _snapshot;
+}
+
+/**
+ * Get Idle Time
+ *
+ * @return ms until run() has something to do, the MCU can sleep that long
+ */
+unsigned long LC709204FDutyCycle::getIdleTime(void) {
+    unsigned long now = millis();
+
+    if (_state == LC709204F_DUTY_SLEEPING)
+        return (long)(_due - now) > 0 ? _due - now : 0;
+
+    return now - _wokeAt < _settle ? _settle - (now - _wokeAt) : 0;
+}
+
+lc709204f_duty_state_t LC709204FDutyCycle::getState(void) {
+    return (lc709204f_duty_state_t) _state;
+}
+
+void LC709204FDutyCycle::setPeriod(unsigned long period) {
+    _period = period;
+}
+
+void LC709204FDutyCycle::setSettle(unsigned long settle) {
+    _settle = settle;
+}
+
+/**
+ * Set Bus
+ *
+ * @param frequency I2C SCL frequency in Hz, used for the bus time accounting
+ */
+void LC709204FDutyCycle::setBus(uint32_t frequency) {
+    _frequency = frequency ? frequency : 100000;
+}
+
+/**
+ * Set Currents
+ *
+ * @param operate Gauge supply current in operational mode, nA
+ * @param sleep Gauge supply current in sleep mode, nA
+ */
+void LC709204FDutyCycle::setCurrents(uint32_t operate, uint32_t sleep) {
+    _operateCurrent = operate;
+    _sleepCurrent = sleep;
+}
+
+/**
+ * Get Stats
+ *
+ * @return Accounting since begin() or resetStats(), time in the current mode included
+ */
+lc709204f_duty_stats_t LC709204FDutyCycle::getStats(void) {
+    lc709204f_duty_stats_t stats = _stats;
+    unsigned long elapsed = millis() - _modeSince;
+
+    if (_state == LC709204F_DUTY_SLEEPING)
+        stats.sleepTime += elapsed;
+    else
+        stats.operateTime += elapsed;
+
+    stats.busTime = (uint32_t)((uint64_t) _busBits * 1000000 / _frequency);
+    stats.charge = (uint32_t)(((uint64_t) stats.operateTime * _operateCurrent + (uint64_t) stats.sleepTime * _sleepCurrent) / 1000);
+    return stats;
+}
+
+void LC709204FDutyCycle::resetStats(void) {
+    memset(&_stats, 0, sizeof(_stats));
+    _busBits = 0;
+    _modeSince = millis();
+}
+
+/**
+ * Power mode switch, with time and bus accounting.
+ */
+bool LC709204FDutyCycle::setMode(lc709204f_power_mode_t mode) {
+    uint32_t issued = _gauge.getIssuedWrites();
+    bool success = _gauge.setICPowerMode(mode);
+
+    // A failed write used the bus too, an elided one did not
+    _busBits += (_gauge.getIssuedWrites() - issued) * LC709204F_WRITE_BITS;
+
+    if (!success)
+        return false;
+
+    accountMode(millis());
+    _state = mode == LC709204F_POWER_MODE_OPERATE ? LC709204F_DUTY_SETTLING : LC709204F_DUTY_SLEEPING;
+    return true;
+}
+
+/**
+ * Adds the time since the last mode switch to the current mode.
+ */
+void LC709204FDutyCycle::accountMode(unsigned long now) {
+    if (_state == LC709204F_DUTY_SLEEPING)
+        _stats.sleepTime += now - _modeSince;
+    else
+        _stats.operateTime += now - _modeSince;
+
+    _modeSince = now;
+}
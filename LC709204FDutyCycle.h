@@ -0,0 +1,118 @@
+/**
+ * @file LC709204FDutyCycle.h
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Duty cycled LC709204F acquisition: wake, settle, read, sleep
+ * @copyright MIT (see LICENSE.md)
+ */
+
+#ifndef _LC709204F_DUTY_CYCLE_H
+#define _LC709204F_DUTY_CYCLE_H
+
+#include "LC709204F.h"
+
+#ifndef LC709204F_OPERATE_CURRENT
+#define LC709204F_OPERATE_CURRENT 2000 /// Gauge supply current in operational mode, nA (typical, check the datasheet)
+#endif
+
+#ifndef LC709204F_SLEEP_CURRENT
+#define LC709204F_SLEEP_CURRENT 1000 /// Gauge supply current in sleep mode, nA (typical, check the datasheet)
+#endif
+
+/**
+ * Duty cycle state
+ */
+typedef enum {
+    LC709204F_DUTY_SLEEPING = 0, /// Gauge in sleep mode, waiting for the next period
+    LC709204F_DUTY_SETTLING = 1, /// Gauge woken up, waiting for fresh measurements
+} lc709204f_duty_state_t;
+
+/**
+ * Duty cycle accounting
+ */
+typedef struct {
+    uint32_t cycles;           /// Completed acquisitions
+    uint32_t failures;         /// Acquisitions that did not read all fields
+    unsigned long lastLatency; /// ms from the wake up write to valid data, last acquisition
+    unsigned long maxLatency;  /// Largest lastLatency seen
+    uint32_t operateTime;      /// ms spent in operational mode
+    uint32_t sleepTime;        /// ms spent in sleep mode
+    uint32_t busTime;          /// µs of I2C bus time used by the reads and writes the driver issued
+    uint32_t charge;           /// nC (nA·s) drawn by the gauge, from the mode times and currents
+} lc709204f_duty_stats_t;
+
+/**
+ * Duty cycled acquisition
+ *
+ * Keeps the gauge in sleep mode and, once per period: switches it to operational mode, waits
+ * for the settle time so the measurements are fresh, reads the requested fields as one snapshot
+ * and puts it back to sleep. run() never blocks; getIdleTime() tells how long the MCU can sleep.
+ *
+ *   LC709204FDutyCycle dutyCycle(batteryMonitor, 60000, 1500); // every minute, 1.5s settle
+ *   ...
+ *   if (dutyCycle.run())
+ *       use(dutyCycle.getSnapshot());
+ */
+class LC709204FDutyCycle {
+public:
+    LC709204FDutyCycle(LC709204F &gauge, unsigned long period, unsigned long settle, uint16_t fields = LC709204F_FIELD_ALL);
+
+    bool begin(void);
+
+    bool run(void);
+
+    bool acquire(void);
+
+    const lc709204f_battery_snapshot_t &getSnapshot(void);
+
+    unsigned long getIdleTime(void);
+
+    lc709204f_duty_state_t getState(void);
+
+    void setPeriod(unsigned long period);
+
+    void setSettle(unsigned long settle);
+
+    void setBus(uint32_t frequency);
+
+    void setCurrents(uint32_t operate, uint32_t sleep);
+
+    lc709204f_duty_stats_t getStats(void);
+
+    void resetStats(void);
+
+private:
+    LC709204F &_gauge;
+
+    unsigned long _period;
+
+    unsigned long _settle;
+
+    uint16_t _fields;
+
+    uint8_t _state;
+
+    unsigned long _due;
+
+    unsigned long _wokeAt;
+
+    unsigned long _modeSince;
+
+    uint32_t _frequency;
+
+    uint32_t _operateCurrent;
+
+    uint32_t _sleepCurrent;
+
+    uint32_t _busBits;
+
+    lc709204f_battery_snapshot_t _snapshot;
+
+    lc709204f_duty_stats_t _stats;
+
+    bool setMode(lc709204f_power_mode_t mode);
+
+    void accountMode(unsigned long now);
+};
+
+#endif
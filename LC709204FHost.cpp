@@ -0,0 +1,292 @@
+/**
+ * @file LC709204FHost.cpp
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Host (Linux) replacement for the Arduino core and Wire, used when LC709204F_HOST_BUILD is defined
+ * @copyright MIT (see LICENSE.md)
+ */
+
+#include "LC709204FHost.h"
+
+#if defined(LC709204F_HOST_BUILD)
+
+#include <time.h>
+
+TwoWire Wire;
+
+LC709204FHostGpio Gpio;
+
+/**
+ * Arduino map() equivalent.
+ */
+long map(long x, long in_min, long in_max, long out_min, long out_max) {
+    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+/**
+ * Monotonic clock in microseconds.
+ */
+static uint64_t monotonicMicros(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+unsigned long millis(void) {
+    return (unsigned long)(monotonicMicros() / 1000);
+}
+
+unsigned long micros(void) {
+    return (unsigned long) monotonicMicros();
+}
+
+void delay(unsigned long ms) {
+    struct timespec ts;
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = (ms % 1000) * 1000000L;
+    nanosleep(&ts, NULL);
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    (void) pin;
+    (void) mode;
+}
+
+int digitalRead(uint8_t pin) {
+    return Gpio.get(pin);
+}
+
+void digitalWrite(uint8_t pin, uint8_t level) {
+    Gpio.set(pin, level);
+}
+
+void attachInterrupt(int interrupt, void (*handler)(void), int mode) {
+    if (interrupt >= 0)
+        Gpio.attach((uint8_t) interrupt, handler, mode);
+}
+
+void detachInterrupt(int interrupt) {
+    if (interrupt >= 0)
+        Gpio.detach((uint8_t) interrupt);
+}
+
+void noInterrupts(void) {}
+
+void interrupts(void) {}
+
+/**
+ * Host GPIO class
+ */
+LC709204FHostGpio::LC709204FHostGpio() {
+    for (uint8_t i = 0; i < LC709204F_HOST_PINS; i++) {
+        _levels[i] = HIGH;
+        _handlers[i] = NULL;
+        _modes[i] = 0;
+    }
+}
+
+/**
+ * Drive a pin, calling the attached interrupt handler on a matching edge.
+ */
+void LC709204FHostGpio::set(uint8_t pin, uint8_t level) {
+    if (pin >= LC709204F_HOST_PINS)
+        return;
+
+    level = level ? HIGH : LOW;
+    if (level == _levels[pin])
+        return;
+
+    _levels[pin] = level;
+
+    if (_handlers[pin] != NULL && (_modes[pin] == CHANGE || (_modes[pin] == FALLING && level == LOW) || (_modes[pin] == RISING && level == HIGH)))
+        _handlers[pin]();
+}
+
+uint8_t LC709204FHostGpio::get(uint8_t pin) {
+    return pin < LC709204F_HOST_PINS ? _levels[pin] : HIGH;
+}
+
+void LC709204FHostGpio::attach(uint8_t pin, void (*handler)(void), int mode) {
+    if (pin < LC709204F_HOST_PINS) {
+        _handlers[pin] = handler;
+        _modes[pin] = (uint8_t) mode;
+    }
+}
+
+void LC709204FHostGpio::detach(uint8_t pin) {
+    if (pin < LC709204F_HOST_PINS)
+        _handlers[pin] = NULL;
+}
+
+/**
+ * Host TwoWire class
+ */
+TwoWire::TwoWire() {
+    for (uint8_t i = 0; i < MAX_DEVICES; i++) {
+        _devices[i] = NULL;
+    }
+    _txAddress = 0;
+    _txLen = 0;
+    _rxLen = 0;
+    _rxPos = 0;
+    resetStats();
+}
+
+void TwoWire::begin(void) {}
+
+void TwoWire::setClock(uint32_t frequency) {
+    (void) frequency;
+}
+
+/**
+ * Attach a device to the bus.
+ *
+ * @param address 7-bit i2c address the device answers to
+ * @param device The device
+ * @return True if the device was attached
+ */
+bool TwoWire::attach(uint8_t address, LC709204FBusDevice *device) {
+    detach(address);
+
+    for (uint8_t i = 0; i < MAX_DEVICES; i++) {
+        if (_devices[i] == NULL) {
+            _addresses[i] = address;
+            _devices[i] = device;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Detach the device answering to an address.
+ *
+ * @param address 7-bit i2c address
+ */
+void TwoWire::detach(uint8_t address) {
+    for (uint8_t i = 0; i < MAX_DEVICES; i++) {
+        if (_devices[i] != NULL && _addresses[i] == address)
+            _devices[i] = NULL;
+    }
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+    _txAddress = address;
+    _txLen = 0;
+}
+
+size_t TwoWire::write(uint8_t data) {
+    if (_txLen >= LC709204F_HOST_WIRE_BUFFER_LENGTH)
+        return 0;
+
+    _txBuffer[_txLen++] = data;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t *buffer, size_t len) {
+    size_t written = 0;
+
+    while (written < len && write(buffer[written]))
+        written++;
+
+    return written;
+}
+
+/**
+ * Ends a write transfer.
+ *
+ * @return 0 on success, 2 on address NACK, 3 on data NACK
+ */
+uint8_t TwoWire::endTransmission(bool stop) {
+    LC709204FBusDevice *device = find(_txAddress);
+
+    if (device == NULL) {
+        count(0, true);
+        return 2;
+    }
+
+    count(_txLen, stop);
+
+    return device->receive(_txBuffer, _txLen, stop);
+}
+
+/**
+ * Reads from a device.
+ *
+ * @return Number of bytes received
+ */
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity, uint8_t stop) {
+    LC709204FBusDevice *device = find(address);
+
+    _rxLen = 0;
+    _rxPos = 0;
+
+    if (device == NULL) {
+        count(0, true);
+        return 0;
+    }
+
+    if (quantity > LC709204F_HOST_WIRE_BUFFER_LENGTH)
+        quantity = LC709204F_HOST_WIRE_BUFFER_LENGTH;
+
+    _rxLen = device->request(_rxBuffer, quantity, stop != 0);
+    count(quantity, stop != 0);
+    return (uint8_t) _rxLen;
+}
+
+int TwoWire::available(void) {
+    return (int)(_rxLen - _rxPos);
+}
+
+int TwoWire::read(void) {
+    if (_rxPos >= _rxLen)
+        return -1;
+
+    return _rxBuffer[_rxPos++];
+}
+
+/**
+ * Get the traffic counted since the last resetStats().
+ */
+lc709204f_bus_stats_t TwoWire::getStats(void) {
+    return _stats;
+}
+
+/**
+ * Reset the traffic counters.
+ */
+void TwoWire::resetStats(void) {
+    _stats.transactions = 0;
+    _stats.bytes = 0;
+    _stats.bits = 0;
+}
+
+/**
+ * Time the counted traffic takes on a real bus.
+ *
+ * @param stats Counted traffic
+ * @param frequency SCL frequency in Hz, eg: 100000 or 400000
+ * @return Bus time in microseconds
+ */
+uint32_t TwoWire::busTimeMicros(const lc709204f_bus_stats_t &stats, uint32_t frequency) {
+    return (uint32_t)((uint64_t) stats.bits * 1000000 / frequency);
+}
+
+/**
+ * Count one transfer: START, address byte, data bytes and optional STOP.
+ */
+void TwoWire::count(size_t len, bool stop) {
+    _stats.transactions++;
+    _stats.bytes += 1 + len;
+    _stats.bits += 1 + 9 * (1 + len) + (stop ? 1 : 0);
+}
+
+LC709204FBusDevice *TwoWire::find(uint8_t address) {
+    for (uint8_t i = 0; i < MAX_DEVICES; i++) {
+        if (_devices[i] != NULL && _addresses[i] == address)
+            return _devices[i];
+    }
+    return NULL;
+}
+
+#endif
@@ -0,0 +1,193 @@
+/**
+ * @file LC709204FHost.h
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Host (Linux) replacement for the Arduino core and Wire, used when LC709204F_HOST_BUILD is defined
+ * @copyright MIT (see LICENSE.md)
+ */
+
+#ifndef _LC709204F_HOST_H
+#define _LC709204F_HOST_H
+
+#if defined(LC709204F_HOST_BUILD)
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+
+#ifndef pgm_read_byte
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#endif
+
+#define LC709204F_HOST_WIRE_BUFFER_LENGTH 32 /// Same transmit/receive buffer size as the Arduino Wire library.
+
+long map(long x, long in_min, long in_max, long out_min, long out_max);
+
+unsigned long millis(void);
+
+unsigned long micros(void);
+
+void delay(unsigned long ms);
+
+#define LOW 0
+#define HIGH 1
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+#define LC709204F_HOST_PINS 64 /// Number of simulated GPIO pins, interrupt numbers equal pin numbers.
+
+#define digitalPinToInterrupt(pin) ((pin) < LC709204F_HOST_PINS ? (int)(pin) : -1)
+
+void pinMode(uint8_t pin, uint8_t mode);
+
+int digitalRead(uint8_t pin);
+
+void digitalWrite(uint8_t pin, uint8_t level);
+
+void attachInterrupt(int interrupt, void (*handler)(void), int mode);
+
+void detachInterrupt(int interrupt);
+
+void noInterrupts(void);
+
+void interrupts(void);
+
+/**
+ * Traffic counted by the host TwoWire bus
+ */
+typedef struct {
+    uint32_t transactions; /// START conditions (START or repeated START)
+    uint32_t bytes;        /// Bytes on the wire, address bytes included
+    uint32_t bits;         /// SCL clock periods: 9 per byte (ACK included), 1 per START and STOP
+} lc709204f_bus_stats_t;
+
+/**
+ * A device attached to the host TwoWire bus
+ */
+class LC709204FBusDevice {
+public:
+    virtual ~LC709204FBusDevice() {}
+
+    /**
+     * Handles a master write, called by endTransmission.
+     *
+     * @return 0 on success, 3 on data NACK, as returned by endTransmission
+     */
+    virtual uint8_t receive(const uint8_t *buffer, size_t len, bool stop) = 0;
+
+    /**
+     * Handles a master read, called by requestFrom.
+     *
+     * @return Number of bytes the device returned
+     */
+    virtual size_t request(uint8_t *buffer, size_t len, bool stop) = 0;
+};
+
+/**
+ * Host TwoWire bus
+ *
+ * Same interface as the Arduino TwoWire class, but transfers are routed to the
+ * LC709204FBusDevice objects attached to it instead of a hardware I2C peripheral.
+ */
+class TwoWire {
+public:
+    TwoWire();
+
+    void begin(void);
+
+    void setClock(uint32_t frequency);
+
+    bool attach(uint8_t address, LC709204FBusDevice *device);
+
+    void detach(uint8_t address);
+
+    void beginTransmission(uint8_t address);
+
+    size_t write(uint8_t data);
+
+    size_t write(const uint8_t *buffer, size_t len);
+
+    uint8_t endTransmission(bool stop = true);
+
+    uint8_t requestFrom(uint8_t address, uint8_t quantity, uint8_t stop = 1);
+
+    int available(void);
+
+    int read(void);
+
+    lc709204f_bus_stats_t getStats(void);
+
+    void resetStats(void);
+
+    static uint32_t busTimeMicros(const lc709204f_bus_stats_t &stats, uint32_t frequency);
+
+private:
+    static const uint8_t MAX_DEVICES = 8;
+
+    uint8_t _addresses[MAX_DEVICES];
+
+    LC709204FBusDevice *_devices[MAX_DEVICES];
+
+    uint8_t _txAddress;
+
+    uint8_t _txBuffer[LC709204F_HOST_WIRE_BUFFER_LENGTH];
+
+    size_t _txLen;
+
+    uint8_t _rxBuffer[LC709204F_HOST_WIRE_BUFFER_LENGTH];
+
+    size_t _rxLen;
+
+    size_t _rxPos;
+
+    lc709204f_bus_stats_t _stats;
+
+    void count(size_t len, bool stop);
+
+    LC709204FBusDevice *find(uint8_t address);
+};
+
+extern TwoWire Wire;
+
+/**
+ * Simulated GPIO pins
+ *
+ * Pins idle HIGH, as with INPUT_PULLUP. Devices (eg: the ALARMB output of LC709204FSimulator)
+ * or the test drive them with set(); the handler attached with attachInterrupt() runs
+ * synchronously on the matching edge, like an ISR would.
+ */
+class LC709204FHostGpio {
+public:
+    LC709204FHostGpio();
+
+    void set(uint8_t pin, uint8_t level);
+
+    uint8_t get(uint8_t pin);
+
+    void attach(uint8_t pin, void (*handler)(void), int mode);
+
+    void detach(uint8_t pin);
+
+private:
+    uint8_t _levels[LC709204F_HOST_PINS];
+
+    void (*_handlers[LC709204F_HOST_PINS])(void);
+
+    uint8_t _modes[LC709204F_HOST_PINS];
+};
+
+extern LC709204FHostGpio Gpio;
+
+#endif
+
+#endif
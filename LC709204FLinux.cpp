@@ -0,0 +1,118 @@
+/**
+ * @file LC709204FLinux.cpp
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Linux i2c-dev bus for the LC709204F driver (LC709204F_TRANSPORT_LINUX)
+ * @copyright MIT (see LICENSE.md)
+ */
+
+#include "LC709204FLinux.h"
+
+#if defined(LC709204F_TRANSPORT_LINUX)
+
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+LC709204FLinuxI2C LinuxI2C;
+
+/**
+ * ioctl() itself, the default hook.
+ */
+static int systemIoctl(int fd, unsigned long request, void *arg) {
+    return ioctl(fd, request, arg);
+}
+
+/**
+ * LC709204FLinuxI2C class
+ *
+ * @param device Path of the i2c-dev adapter, eg: "/dev/i2c-1"
+ */
+LC709204FLinuxI2C::LC709204FLinuxI2C(const char *device) {
+    _device = device;
+    _fd = -1;
+    _ioctl = systemIoctl;
+    _ioctls = 0;
+}
+
+LC709204FLinuxI2C::~LC709204FLinuxI2C() {
+    end();
+}
+
+/**
+ * Begin
+ *
+ * Opens the adapter, if not open already.
+ *
+ * @return True if the adapter is open
+ */
+bool LC709204FLinuxI2C::begin(void) {
+    if (_fd < 0)
+        _fd = open(_device, O_RDWR | O_CLOEXEC);
+
+    return _fd >= 0;
+}
+
+/**
+ * End
+ *
+ * Closes the adapter.
+ */
+void LC709204FLinuxI2C::end(void) {
+    if (_fd >= 0)
+        close(_fd);
+
+    _fd = -1;
+}
+
+/**
+ * Transfer
+ *
+ * Sends the messages as one I2C_RDWR ioctl: a single transaction, the messages joined by
+ * repeated STARTs and a STOP after the last one.
+ *
+ * @param messages Messages, at most LC709204F_LINUX_MAX_MESSAGES
+ * @param count Number of messages
+ * @return 0 on success, the errno of the failure otherwise
+ */
+int LC709204FLinuxI2C::transfer(struct i2c_msg *messages, uint32_t count) {
+    struct i2c_rdwr_ioctl_data data;
+
+    data.msgs = messages;
+    data.nmsgs = count;
+    _ioctls++;
+
+    if (_ioctl(_fd, I2C_RDWR, &data) < 0)
+        return errno ? errno : EIO;
+
+    return 0;
+}
+
+/**
+ * Set Ioctl
+ *
+ * @param hook Function called instead of ioctl(), NULL to restore ioctl()
+ */
+void LC709204FLinuxI2C::setIoctl(lc709204f_ioctl_t hook) {
+    _ioctl = hook != NULL ? hook : systemIoctl;
+}
+
+/**
+ * Get Fd
+ *
+ * @return File descriptor of the adapter, -1 if not open
+ */
+int LC709204FLinuxI2C::getFd(void) {
+    return _fd;
+}
+
+/**
+ * Get Ioctls
+ *
+ * @return Number of I2C_RDWR ioctls issued
+ */
+uint32_t LC709204FLinuxI2C::getIoctls(void) {
+    return _ioctls;
+}
+
+#endif
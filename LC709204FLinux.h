@@ -0,0 +1,76 @@
+/**
+ * @file LC709204FLinux.h
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Linux i2c-dev bus for the LC709204F driver (LC709204F_TRANSPORT_LINUX)
+ * @copyright MIT (see LICENSE.md)
+ */
+
+#ifndef _LC709204F_LINUX_H
+#define _LC709204F_LINUX_H
+
+#if defined(LC709204F_TRANSPORT_LINUX)
+
+#if !defined(LC709204F_HOST_BUILD)
+#error "LC709204F_TRANSPORT_LINUX needs LC709204F_HOST_BUILD for millis(), delay() and the other Arduino functions"
+#endif
+
+#include <errno.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+#include "LC709204FHost.h"
+
+#ifndef LC709204F_LINUX_DEVICE
+#define LC709204F_LINUX_DEVICE "/dev/i2c-1" /// i2c-dev adapter of the LinuxI2C bus.
+#endif
+
+#define LC709204F_LINUX_MAX_MESSAGES I2C_RDWR_IOCTL_MAX_MSGS /// Messages the kernel accepts in one I2C_RDWR ioctl.
+
+/**
+ * ioctl() replacement, eg: a fake adapter for tests without hardware
+ *
+ * @return Same as ioctl(): -1 with errno set on failure
+ */
+typedef int (*lc709204f_ioctl_t)(int fd, unsigned long request, void *arg);
+
+/**
+ * Linux i2c-dev adapter
+ *
+ *   LC709204FLinuxI2C bus("/dev/i2c-0");
+ *   LC709204F batteryMonitor(&bus);
+ *
+ * LC709204F uses the LinuxI2C instance (LC709204F_LINUX_DEVICE) by default.
+ */
+class LC709204FLinuxI2C {
+public:
+    LC709204FLinuxI2C(const char *device = LC709204F_LINUX_DEVICE);
+
+    ~LC709204FLinuxI2C();
+
+    bool begin(void);
+
+    void end(void);
+
+    int transfer(struct i2c_msg *messages, uint32_t count);
+
+    void setIoctl(lc709204f_ioctl_t hook);
+
+    int getFd(void);
+
+    uint32_t getIoctls(void);
+
+private:
+    const char *_device;
+
+    int _fd;
+
+    lc709204f_ioctl_t _ioctl;
+
+    uint32_t _ioctls;
+};
+
+extern LC709204FLinuxI2C LinuxI2C;
+
+#endif
+
+#endif
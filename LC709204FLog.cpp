@@ -0,0 +1,236 @@
+/**
+ * @file LC709204FLog.cpp
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Compact binary log of LC709204F battery snapshots
+ * @copyright MIT (see LICENSE.md)
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "LC709204FLog.h"
+
+/**
+ * Offsets of the snapshot fields, in lc709204f_snapshot_field_t bit order.
+ */
+static const uint8_t LC709204F_LOG_OFFSETS[LC709204F_LOG_FIELDS] = {
+    offsetof(lc709204f_battery_snapshot_t, cellVoltage),
+    offsetof(lc709204f_battery_snapshot_t, rsoc),
+    offsetof(lc709204f_battery_snapshot_t, ite),
+    offsetof(lc709204f_battery_snapshot_t, timeToEmpty),
+    offsetof(lc709204f_battery_snapshot_t, timeToFull),
+    offsetof(lc709204f_battery_snapshot_t, cellTemperature),
+    offsetof(lc709204f_battery_snapshot_t, ambientTemperature),
+    offsetof(lc709204f_battery_snapshot_t, batteryStatus),
+    offsetof(lc709204f_battery_snapshot_t, cycleCount),
+    offsetof(lc709204f_battery_snapshot_t, stateOfHealth),
+};
+
+static uint16_t *snapshotField(lc709204f_battery_snapshot_t &snapshot, uint8_t field) {
+    return (uint16_t *)((uint8_t *) &snapshot + LC709204F_LOG_OFFSETS[field]);
+}
+
+static uint16_t snapshotField(const lc709204f_battery_snapshot_t &snapshot, uint8_t field) {
+    return *(const uint16_t *)((const uint8_t *) &snapshot + LC709204F_LOG_OFFSETS[field]);
+}
+
+/**
+ * Writes a LEB128 varint, 7 bits per byte, lowest bits first.
+ *
+ * @return Pointer past the last byte written
+ */
+static uint8_t *putVarint(uint8_t *p, uint32_t value) {
+    while (value >= 0x80) {
+        *p++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *p++ = (uint8_t) value;
+    return p;
+}
+
+/**
+ * Reads a LEB128 varint of up to 32 bits.
+ *
+ * @return Pointer past the last byte read, NULL if the buffer ends first or the value is too long
+ */
+static const uint8_t *getVarint(const uint8_t *p, const uint8_t *end, uint32_t *value) {
+    uint32_t result = 0;
+
+    for (uint8_t shift = 0; shift < 35; shift += 7) {
+        if (p == end)
+            return NULL;
+
+        uint8_t b = *p++;
+        result |= (uint32_t)(b & 0x7F) << shift;
+
+        if (!(b & 0x80)) {
+            *value = result;
+            return p;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Maps a 16-bit difference to an unsigned value, small magnitudes to small values.
+ */
+static inline uint16_t zigzag(uint16_t delta) {
+    return (uint16_t)((delta << 1) ^ ((int16_t) delta >> 15));
+}
+
+static inline uint16_t unzigzag(uint16_t value) {
+    return (uint16_t)((value >> 1) ^ -(value & 1));
+}
+
+/**
+ * LC709204FLogEncoder class
+ *
+ * @param fields Mask of lc709204f_snapshot_field_t values to log (default LC709204F_FIELD_ALL)
+ * @param keyframeInterval Number of records between keyframes, a keyframe lets decoding start there
+ */
+LC709204FLogEncoder::LC709204FLogEncoder(uint16_t fields, uint16_t keyframeInterval) {
+    _fields = fields & LC709204F_FIELD_ALL;
+    _keyframeInterval = keyframeInterval ? keyframeInterval : 1;
+    reset();
+}
+
+/**
+ * Encode
+ *
+ * Only the fields both logged and valid in the snapshot are stored.
+ *
+ * @param snapshot The snapshot to log
+ * @param timestamp Time of the snapshot in ms, eg: millis(), 32-bit
+ * @param buffer Buffer to write the record to
+ * @param size Size of the buffer, LC709204F_LOG_MAX_RECORD is always enough
+ * @return Number of bytes written, 0 if the buffer is too small
+ */
+size_t LC709204FLogEncoder::encode(const lc709204f_battery_snapshot_t &snapshot, uint32_t timestamp, uint8_t *buffer, size_t size) {
+    uint8_t record[LC709204F_LOG_MAX_RECORD];
+    uint16_t mask = snapshot.valid & _fields;
+    bool keyframe = _sinceKeyframe == 0 || (mask & ~_known);
+    uint8_t *p = record;
+
+    p = putVarint(p, (uint32_t) mask << 1 | (keyframe ? 1 : 0));
+    p = putVarint(p, keyframe ? timestamp : timestamp - _timestamp);
+
+    for (uint8_t i = 0; i < LC709204F_LOG_FIELDS; i++) {
+        if (!(mask & (1 << i)))
+            continue;
+
+        uint16_t value = snapshotField(snapshot, i);
+        p = putVarint(p, keyframe ? value : zigzag(value - _previous[i]));
+        _previous[i] = value;
+    }
+
+    size_t len = p - record;
+    if (len > size) {
+        // Nothing was written, the next record must not be a delta against this one
+        reset();
+        return 0;
+    }
+
+    memcpy(buffer, record, len);
+
+    if (keyframe) {
+        _known = mask;
+        _sinceKeyframe = 0;
+    } else {
+        _known |= mask;
+    }
+    _timestamp = timestamp;
+
+    if (++_sinceKeyframe >= _keyframeInterval)
+        _sinceKeyframe = 0;
+
+    return len;
+}
+
+/**
+ * Reset
+ *
+ * Makes the next record a keyframe, eg: when starting a new log file.
+ */
+void LC709204FLogEncoder::reset(void) {
+    _sinceKeyframe = 0;
+    _known = 0;
+    _timestamp = 0;
+}
+
+/**
+ * LC709204FLogDecoder class
+ */
+LC709204FLogDecoder::LC709204FLogDecoder() {
+    reset();
+}
+
+/**
+ * Decode
+ *
+ * Decodes the record at the start of the buffer.
+ *
+ * @param buffer Log data
+ * @param len Number of bytes available
+ * @param snapshot Snapshot to store the record in, snapshot.valid is the mask of the fields
+ *                 stored in the record, the other fields hold their last logged value
+ * @param timestamp Time of the record in ms, wraps like a 32-bit millis()
+ * @return Number of bytes consumed, 0 if the buffer does not hold a complete record,
+ *         LC709204F_LOG_INVALID if the data is corrupt or does not start at a keyframe
+ */
+size_t LC709204FLogDecoder::decode(const uint8_t *buffer, size_t len, lc709204f_battery_snapshot_t &snapshot, uint32_t &timestamp) {
+    const uint8_t *end = buffer + len;
+    const uint8_t *p = buffer;
+    uint16_t values[LC709204F_LOG_FIELDS];
+    uint32_t header;
+    uint32_t time;
+
+    if ((p = getVarint(p, end, &header)) == NULL || (p = getVarint(p, end, &time)) == NULL)
+        return len >= LC709204F_LOG_MAX_RECORD ? LC709204F_LOG_INVALID : 0;
+
+    bool keyframe = header & 1;
+    uint16_t mask = (uint16_t)(header >> 1);
+
+    if ((header >> 1) & ~(uint32_t) LC709204F_FIELD_ALL || (!keyframe && !_synced))
+        return LC709204F_LOG_INVALID;
+
+    for (uint8_t i = 0; i < LC709204F_LOG_FIELDS; i++) {
+        uint32_t value;
+
+        if (!(mask & (1 << i))) {
+            values[i] = _previous[i];
+            continue;
+        }
+
+        if ((p = getVarint(p, end, &value)) == NULL)
+            return len >= LC709204F_LOG_MAX_RECORD ? LC709204F_LOG_INVALID : 0;
+
+        if (value > 0xFFFF)
+            return LC709204F_LOG_INVALID;
+
+        values[i] = keyframe ? (uint16_t) value : (uint16_t)(_previous[i] + unzigzag((uint16_t) value));
+    }
+
+    // Complete record, commit
+    _synced = true;
+    _timestamp = keyframe ? time : _timestamp + time;
+    memcpy(_previous, values, sizeof(_previous));
+
+    for (uint8_t i = 0; i < LC709204F_LOG_FIELDS; i++) {
+        *snapshotField(snapshot, i) = values[i];
+    }
+    snapshot.valid = mask;
+    timestamp = _timestamp;
+
+    return p - buffer;
+}
+
+/**
+ * Reset
+ *
+ * Forgets the previous record, decoding restarts at the next keyframe.
+ */
+void LC709204FLogDecoder::reset(void) {
+    _synced = false;
+    _timestamp = 0;
+    memset(_previous, 0, sizeof(_previous));
+}
@@ -0,0 +1,83 @@
+/**
+ * @file LC709204FLog.h
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Compact binary log of LC709204F battery snapshots
+ * @copyright MIT (see LICENSE.md)
+ */
+
+#ifndef _LC709204F_LOG_H
+#define _LC709204F_LOG_H
+
+#include "LC709204F.h"
+
+/**
+ * Record format
+ *
+ * Every record starts with a header varint: bit 0 is set on keyframes, the other bits are the
+ * lc709204f_snapshot_field_t mask of the fields stored in the record. Then follow the timestamp
+ * and the fields, in lc709204f_snapshot_field_t bit order, all as LEB128 varints:
+ * - keyframe: timestamp in ms and raw register values
+ * - delta: ms since the previous record and zigzag encoded 16-bit difference with the
+ *   previous value of the field
+ * A field missing from a record keeps its previous value. Decoding starts at a keyframe.
+ * Timestamps are 32-bit, like millis() on the MCU: they wrap after 49.7 days, and a delta across
+ * the wrap decodes to the wrapped value.
+ */
+#define LC709204F_LOG_FIELDS 10 /// Number of lc709204f_snapshot_field_t fields
+
+#define LC709204F_LOG_MAX_RECORD (2 + 5 + LC709204F_LOG_FIELDS * 3) /// Largest encoded record, in bytes
+
+#define LC709204F_LOG_KEYFRAME_INTERVAL 64 /// Default number of records between keyframes
+
+#define LC709204F_LOG_INVALID ((size_t) -1) /// LC709204FLogDecoder::decode result for corrupt data
+
+/**
+ * Streaming log encoder
+ *
+ *   LC709204FLogEncoder encoder;
+ *   uint8_t record[LC709204F_LOG_MAX_RECORD];
+ *   size_t len = encoder.encode(snapshot, millis(), record, sizeof(record));
+ */
+class LC709204FLogEncoder {
+public:
+    LC709204FLogEncoder(uint16_t fields = LC709204F_FIELD_ALL, uint16_t keyframeInterval = LC709204F_LOG_KEYFRAME_INTERVAL);
+
+    size_t encode(const lc709204f_battery_snapshot_t &snapshot, uint32_t timestamp, uint8_t *buffer, size_t size);
+
+    void reset(void);
+
+private:
+    uint16_t _fields;
+
+    uint16_t _keyframeInterval;
+
+    uint16_t _sinceKeyframe;
+
+    uint16_t _known;
+
+    uint32_t _timestamp;
+
+    uint16_t _previous[LC709204F_LOG_FIELDS];
+};
+
+/**
+ * Streaming log decoder
+ */
+class LC709204FLogDecoder {
+public:
+    LC709204FLogDecoder();
+
+    size_t decode(const uint8_t *buffer, size_t len, lc709204f_battery_snapshot_t &snapshot, uint32_t &timestamp);
+
+    void reset(void);
+
+private:
+    bool _synced;
+
+    uint32_t _timestamp;
+
+    uint16_t _previous[LC709204F_LOG_FIELDS];
+};
+
+#endif
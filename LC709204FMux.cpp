@@ -0,0 +1,151 @@
+/**
+ * @file LC709204FMux.cpp
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Several LC709204F battery monitors behind a TCA9548A-style I2C multiplexer
+ * @copyright MIT (see LICENSE.md)
+ */
+
+#include "LC709204FMux.h"
+
+/**
+ * LC709204FMux class
+ *
+ * @param bus The bus the multiplexer is connected to, see LC709204F_BUS
+ * @param address 7-bit i2c address of the multiplexer
+ */
+LC709204FMux::LC709204FMux(LC709204F_BUS *bus, uint8_t address) : _transport(bus) {
+    _address = address;
+    _channel = LC709204F_MUX_NO_CHANNEL;
+    _count = 0;
+    _switches = 0;
+}
+
+/**
+ * Add Gauge
+ *
+ * @param gauge LC709204F connected to the multiplexer, using the same Wire object
+ * @param channel Multiplexer channel (0 to 7) the gauge is connected to
+ * @return Gauge index, or -1 if LC709204F_MUX_MAX_GAUGES gauges were already added
+ */
+int8_t LC709204FMux::addGauge(LC709204F *gauge, uint8_t channel) {
+    if (_count >= LC709204F_MUX_MAX_GAUGES || channel >= LC709204F_MUX_CHANNELS)
+        return -1;
+
+    _gauges[_count] = gauge;
+    _channels[_count] = channel;
+    return _count++;
+}
+
+/**
+ * Get Gauge Count
+ *
+ * @return Number of gauges added
+ */
+uint8_t LC709204FMux::getGaugeCount(void) {
+    return _count;
+}
+
+/**
+ * Select
+ *
+ * Selects the channel of a gauge, if not already selected.
+ *
+ * @param index Gauge index returned by addGauge
+ * @return The gauge, ready to be used, or NULL if the channel could not be selected
+ */
+LC709204F *LC709204FMux::select(uint8_t index) {
+    if (index >= _count || !selectChannel(_channels[index]))
+        return NULL;
+
+    return _gauges[index];
+}
+
+/**
+ * Select Channel
+ *
+ * Writes the channel to the multiplexer, unless it is already the selected one.
+ *
+ * @param channel Multiplexer channel (0 to 7)
+ * @return True on I2C command success
+ */
+bool LC709204FMux::selectChannel(uint8_t channel) {
+    if (channel >= LC709204F_MUX_CHANNELS)
+        return false;
+
+    if (channel == _channel)
+        return true;
+
+    uint8_t mask = 1 << channel;
+
+    if (_transport.write(_address, &mask, 1, true) != 0) {
+        _channel = LC709204F_MUX_NO_CHANNEL;
+        return false;
+    }
+
+    _channel = channel;
+    _switches++;
+    return true;
+}
+
+/**
+ * Get Selected Channel
+ *
+ * @return The cached selected channel, or LC709204F_MUX_NO_CHANNEL
+ */
+uint8_t LC709204FMux::getSelectedChannel(void) {
+    return _channel;
+}
+
+/**
+ * Invalidate Channel
+ *
+ * Forgets the cached channel, eg: after the multiplexer was reset or written by other code.
+ */
+void LC709204FMux::invalidateChannel(void) {
+    _channel = LC709204F_MUX_NO_CHANNEL;
+}
+
+/**
+ * Read All
+ *
+ * Reads a snapshot of every gauge. Gauges are read grouped per channel, starting with the
+ * channel already selected and going round the channels from there, so each channel is
+ * selected at most once per call.
+ *
+ * @param snapshots Array of getGaugeCount() snapshots, indexed by gauge index
+ * @param fields Mask of lc709204f_snapshot_field_t values to read (default LC709204F_FIELD_ALL)
+ * @return Number of gauges for which all requested fields were read
+ */
+uint8_t LC709204FMux::readAll(lc709204f_battery_snapshot_t *snapshots, uint16_t fields) {
+    uint8_t first = _channel == LC709204F_MUX_NO_CHANNEL ? 0 : _channel;
+    uint8_t complete = 0;
+
+    for (uint8_t i = 0; i < LC709204F_MUX_CHANNELS; i++) {
+        uint8_t channel = (first + i) % LC709204F_MUX_CHANNELS;
+
+        for (uint8_t index = 0; index < _count; index++) {
+            if (_channels[index] != channel)
+                continue;
+
+            if (!selectChannel(channel)) {
+                snapshots[index].valid = 0;
+                continue;
+            }
+
+            if (_gauges[index]->readSnapshot(snapshots[index], fields))
+                complete++;
+        }
+    }
+
+    return complete;
+}
+
+/**
+ * Get Channel Switches
+ *
+ * @return Number of writes to the multiplexer
+ */
+uint32_t LC709204FMux::getChannelSwitches(void) {
+    return _switches;
+}
@@ -0,0 +1,65 @@
+/**
+ * @file LC709204FMux.h
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Several LC709204F battery monitors behind a TCA9548A-style I2C multiplexer
+ * @copyright MIT (see LICENSE.md)
+ */
+
+#ifndef _LC709204F_MUX_H
+#define _LC709204F_MUX_H
+
+#include "LC709204F.h"
+
+#define LC709204F_MUX_I2CADDR 0x70      /// TCA9548A default i2c address
+#define LC709204F_MUX_CHANNELS 8        /// Number of multiplexer channels
+#define LC709204F_MUX_NO_CHANNEL 0xFF   /// No channel selected / selection unknown
+
+#ifndef LC709204F_MUX_MAX_GAUGES
+#define LC709204F_MUX_MAX_GAUGES 8      /// Number of gauges a LC709204FMux can manage
+#endif
+
+/**
+ * LC709204F battery monitors behind an I2C multiplexer
+ *
+ * The channel currently selected on the multiplexer is cached, so the multiplexer is
+ * only written when a gauge on another channel is accessed. The multiplexer is written through
+ * the same compile time transport as the gauges, see LC709204F_BUS.
+ */
+class LC709204FMux {
+public:
+    LC709204FMux(LC709204F_BUS *bus = LC709204F_DEFAULT_BUS, uint8_t address = LC709204F_MUX_I2CADDR);
+
+    int8_t addGauge(LC709204F *gauge, uint8_t channel);
+
+    uint8_t getGaugeCount(void);
+
+    LC709204F *select(uint8_t index);
+
+    bool selectChannel(uint8_t channel);
+
+    uint8_t getSelectedChannel(void);
+
+    void invalidateChannel(void);
+
+    uint8_t readAll(lc709204f_battery_snapshot_t *snapshots, uint16_t fields = LC709204F_FIELD_ALL);
+
+    uint32_t getChannelSwitches(void);
+
+private:
+    lc709204f_transport_t _transport;
+
+    uint8_t _address;
+
+    uint8_t _channel;
+
+    uint8_t _count;
+
+    LC709204F *_gauges[LC709204F_MUX_MAX_GAUGES];
+
+    uint8_t _channels[LC709204F_MUX_MAX_GAUGES];
+
+    uint32_t _switches;
+};
+
+#endif
@@ -0,0 +1,193 @@
+/**
+ * @file LC709204FRing.h
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Lock-free single producer / single consumer ring of LC709204F samples
+ * @copyright MIT (see LICENSE.md)
+ */
+
+#ifndef _LC709204F_RING_H
+#define _LC709204F_RING_H
+
+#include "LC709204F.h"
+
+/**
+ * Timestamped battery sample
+ */
+typedef struct {
+    unsigned long timestamp;               /// millis() when the read started
+    lc709204f_battery_snapshot_t snapshot; /// Raw register values, see snapshot.valid
+} lc709204f_sample_t;
+
+/**
+ * Fixed capacity, lock-free single producer / single consumer ring
+ *
+ * One task, timer or ISR pushes, another one pops, without locks: each index is written by
+ * one side only and published with release/acquire ordering. The capacity must be a power of 2.
+ *
+ *   LC709204FRing<lc709204f_sample_t, 16> ring;
+ */
+template<typename T, size_t N>
+class LC709204FRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "LC709204FRing capacity must be a power of 2");
+
+public:
+    LC709204FRing() : _head(0), _tail(0), _dropped(0) {}
+
+    /**
+     * Push (producer side)
+     *
+     * @param item The item to copy into the ring
+     * @return False if the ring is full, the item is dropped and counted
+     */
+    bool push(const T &item) {
+        size_t head = __atomic_load_n(&_head, __ATOMIC_RELAXED);
+
+        if (head - __atomic_load_n(&_tail, __ATOMIC_ACQUIRE) >= N) {
+            // The producer is the only writer: no read-modify-write, which Cortex-M0 and AVR lack
+            __atomic_store_n(&_dropped, __atomic_load_n(&_dropped, __ATOMIC_RELAXED) + 1, __ATOMIC_RELAXED);
+            return false;
+        }
+
+        _items[head & (N - 1)] = item;
+        __atomic_store_n(&_head, head + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    /**
+     * Pop (consumer side)
+     *
+     * @param item Where to copy the oldest item
+     * @return False if the ring is empty
+     */
+    bool pop(T &item) {
+        return pop(&item, 1) == 1;
+    }
+
+    /**
+     * Batch pop (consumer side)
+     *
+     * Copies out the oldest items and releases their slots to the producer at once.
+     *
+     * @param items Array to copy the items into
+     * @param count Size of the array
+     * @return Number of items copied, oldest first
+     */
+    size_t pop(T *items, size_t count) {
+        size_t tail = __atomic_load_n(&_tail, __ATOMIC_RELAXED);
+        size_t available = __atomic_load_n(&_head, __ATOMIC_ACQUIRE) - tail;
+
+        if (count > available)
+            count = available;
+
+        for (size_t i = 0; i < count; i++) {
+            items[i] = _items[(tail + i) & (N - 1)];
+        }
+
+        __atomic_store_n(&_tail, tail + count, __ATOMIC_RELEASE);
+        return count;
+    }
+
+    /**
+     * Number of items waiting, exact on the consumer side, a lower bound on the producer side.
+     */
+    size_t size(void) {
+        return __atomic_load_n(&_head, __ATOMIC_ACQUIRE) - __atomic_load_n(&_tail, __ATOMIC_ACQUIRE);
+    }
+
+    bool empty(void) {
+        return size() == 0;
+    }
+
+    static constexpr size_t capacity(void) {
+        return N;
+    }
+
+    /**
+     * Number of pushes rejected because the ring was full.
+     */
+    uint32_t getDropped(void) {
+        return __atomic_load_n(&_dropped, __ATOMIC_RELAXED);
+    }
+
+private:
+    T _items[N];
+
+    size_t _head; /// Free running, written by the producer only
+
+    size_t _tail; /// Free running, written by the consumer only
+
+    uint32_t _dropped;
+};
+
+/**
+ * Periodic producer for a LC709204FRing of lc709204f_sample_t
+ *
+ * Call run() as often as possible from the sampling task/loop; it reads a snapshot every
+ * period milliseconds, without drift, and pushes it to the ring.
+ */
+template<size_t N>
+class LC709204FSampler {
+public:
+    /**
+     * @param gauge The LC709204F to sample, used by the sampling task only
+     * @param ring The ring to push samples to
+     * @param period Sampling period in milliseconds
+     * @param fields Mask of lc709204f_snapshot_field_t values to read (default LC709204F_FIELD_ALL)
+     */
+    LC709204FSampler(LC709204F &gauge, LC709204FRing<lc709204f_sample_t, N> &ring, unsigned long period, uint16_t fields = LC709204F_FIELD_ALL)
+        : _gauge(gauge), _ring(ring), _period(period), _fields(fields), _next(millis()) {}
+
+    /**
+     * Samples when the period elapsed.
+     *
+     * The next sample is due one period after the previous due time, not after now, so the
+     * rate does not drift. Periods missed entirely are skipped, not caught up with.
+     *
+     * @return True if a sample was taken
+     */
+    bool run(void) {
+        unsigned long now = millis();
+
+        if ((long)(now - _next) < 0)
+            return false;
+
+        _next += _period;
+        if ((long)(now - _next) >= 0)
+            _next = now + _period;
+
+        sample();
+        return true;
+    }
+
+    /**
+     * Samples now.
+     *
+     * @return False if the sample could not be pushed because the ring is full. Samples with
+     *         read errors are pushed, with the failed fields cleared from snapshot.valid.
+     */
+    bool sample(void) {
+        lc709204f_sample_t item;
+
+        item.timestamp = millis();
+        _gauge.readSnapshot(item.snapshot, _fields);
+        return _ring.push(item);
+    }
+
+    void setPeriod(unsigned long period) {
+        _period = period;
+    }
+
+private:
+    LC709204F &_gauge;
+
+    LC709204FRing<lc709204f_sample_t, N> &_ring;
+
+    unsigned long _period;
+
+    uint16_t _fields;
+
+    unsigned long _next;
+};
+
+#endif
@@ -0,0 +1,243 @@
+/**
+ * @file LC709204FScheduler.cpp
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Adaptive per-register polling of LC709204F registers
+ * @copyright MIT (see LICENSE.md)
+ */
+
+#include "LC709204FScheduler.h"
+
+static_assert(LC709204F_SCHEDULER_SIZE <= 16, "tick() tracks registers in a 16-bit mask");
+
+/**
+ * Default polling intervals of the measurement registers, in ms.
+ * Configuration registers only change when written and are not polled.
+ */
+static const struct {
+    uint8_t command;
+    uint16_t minInterval;
+    uint16_t maxInterval;
+} LC709204F_SCHEDULER_DEFAULTS[] = {
+    {LC709204F_REG_CELL_VOLTAGE, 1000, 30000},
+    {LC709204F_REG_RSOC, 1000, 60000},
+    {LC709204F_REG_ITE, 1000, 60000},
+    {LC709204F_REG_BATTERY_STATUS, 1000, 10000},
+    {LC709204F_REG_CELL_TEMPERATURE_TSENSE1, 2000, 60000},
+    {LC709204F_REG_AMBIENT_TEMPERATURE_TSENSE2, 5000, 60000},
+    {LC709204F_REG_TIME_TO_EMPTY, 5000, 60000},
+    {LC709204F_REG_TIME_TO_FULL, 5000, 60000},
+    {LC709204F_REG_CYCLE_COUNT, 60000, 60000},
+    {LC709204F_REG_STATE_OF_HEALTH, 60000, 60000},
+};
+
+/**
+ * LC709204FScheduler class
+ *
+ * @param gauge The LC709204F to poll
+ * @param budget Bus time allowed per tick, in microseconds
+ * @param frequency I2C SCL frequency in Hz, used to convert the budget to a number of reads
+ */
+LC709204FScheduler::LC709204FScheduler(LC709204F &gauge, uint32_t budget, uint32_t frequency) : _gauge(gauge) {
+    for (uint8_t i = 0; i < LC709204F_SCHEDULER_SIZE; i++) {
+        _schedule[i].command = 0;
+    }
+    setBudget(budget, frequency);
+}
+
+/**
+ * Add
+ *
+ * The register is due immediately, then polled every minInterval until it proves stable.
+ *
+ * @param command The register to poll, eg: LC709204F_REG_RSOC
+ * @param minInterval Shortest polling interval, in ms
+ * @param maxInterval Longest polling interval, in ms
+ * @return Slot index, or -1 if the register is already polled or all slots are in use
+ */
+int8_t LC709204FScheduler::add(uint8_t command, unsigned long minInterval, unsigned long maxInterval) {
+    if (command == 0 || find(command) >= 0)
+        return -1;
+
+    if (minInterval == 0)
+        minInterval = 1;
+
+    if (maxInterval < minInterval)
+        maxInterval = minInterval;
+
+    for (uint8_t i = 0; i < LC709204F_SCHEDULER_SIZE; i++) {
+        lc709204f_schedule_t &entry = _schedule[i];
+
+        if (entry.command != 0)
+            continue;
+
+        entry.command = command;
+        entry.valid = false;
+        entry.value = 0;
+        entry.due = millis();
+        entry.interval = minInterval;
+        entry.minInterval = minInterval;
+        entry.maxInterval = maxInterval;
+        return i;
+    }
+    return -1;
+}
+
+/**
+ * Add Defaults
+ *
+ * Polls the measurement registers: CellVoltage, RSOC, ITE and BatteryStatus from every second,
+ * temperatures and TimeToEmpty/Full from every few seconds, CycleCount and StateOfHealth every minute.
+ */
+void LC709204FScheduler::addDefaults(void) {
+    for (uint8_t i = 0; i < sizeof(LC709204F_SCHEDULER_DEFAULTS) / sizeof(LC709204F_SCHEDULER_DEFAULTS[0]); i++) {
+        add(LC709204F_SCHEDULER_DEFAULTS[i].command, LC709204F_SCHEDULER_DEFAULTS[i].minInterval, LC709204F_SCHEDULER_DEFAULTS[i].maxInterval);
+    }
+}
+
+/**
+ * Remove
+ *
+ * @param command The register to stop polling
+ * @return False if the register was not polled
+ */
+bool LC709204FScheduler::remove(uint8_t command) {
+    int8_t i = find(command);
+
+    if (i < 0)
+        return false;
+
+    _schedule[i].command = 0;
+    return true;
+}
+
+/**
+ * Tick
+ *
+ * Reads the registers that are due, most overdue first, up to the number of reads that fit in
+ * the bus time budget, with one LC709204F::execute() call. Failed reads are retried at the
+ * next tick without changing the interval.
+ *
+ * @return Number of registers read
+ */
+uint8_t LC709204FScheduler::tick(void) {
+    unsigned long now = millis();
+    lc709204f_batch_item_t items[LC709204F_SCHEDULER_SIZE];
+    uint8_t slots[LC709204F_SCHEDULER_SIZE];
+    uint16_t done = 0;
+    uint8_t reads = 0;
+
+    while (reads < _readsPerTick) {
+        int8_t next = -1;
+        unsigned long overdue = 0;
+
+        for (uint8_t i = 0; i < LC709204F_SCHEDULER_SIZE; i++) {
+            const lc709204f_schedule_t &entry = _schedule[i];
+
+            if (entry.command == 0 || (done & (1 << i)) || (long)(now - entry.due) < 0)
+                continue;
+
+            if (next < 0 || now - entry.due > overdue) {
+                next = i;
+                overdue = now - entry.due;
+            }
+        }
+
+        if (next < 0)
+            break;
+
+        done |= 1 << next;
+        slots[reads] = next;
+        items[reads].command = _schedule[next].command;
+        items[reads].write = false;
+        reads++;
+    }
+
+    if (reads == 0)
+        return 0;
+
+    _gauge.execute(items, reads);
+
+    for (uint8_t i = 0; i < reads; i++) {
+        lc709204f_schedule_t &entry = _schedule[slots[i]];
+        const lc709204f_batch_item_t &result = items[i];
+
+        if (result.status != LC709204F_STATUS_OK)
+            continue;
+
+        if (!entry.valid) {
+            // First value, nothing to compare with yet
+        } else if (result.value == entry.value) {
+            entry.interval += entry.interval / 2 + 1;
+            if (entry.interval > entry.maxInterval)
+                entry.interval = entry.maxInterval;
+        } else {
+            entry.interval /= 2;
+            if (entry.interval < entry.minInterval)
+                entry.interval = entry.minInterval;
+        }
+
+        entry.value = result.value;
+        entry.valid = true;
+        entry.due = now + entry.interval;
+    }
+    return reads;
+}
+
+/**
+ * Get Value
+ *
+ * @param command A polled register
+ * @param value Pointer to store the last value read
+ * @return False if the register is not polled or was not read successfully yet
+ */
+bool LC709204FScheduler::getValue(uint8_t command, uint16_t *value) {
+    int8_t i = find(command);
+
+    if (i < 0 || !_schedule[i].valid)
+        return false;
+
+    *value = _schedule[i].value;
+    return true;
+}
+
+/**
+ * Get Interval
+ *
+ * @param command A polled register
+ * @return Current polling interval in ms, 0 if the register is not polled
+ */
+unsigned long LC709204FScheduler::getInterval(uint8_t command) {
+    int8_t i = find(command);
+
+    return i < 0 ? 0 : _schedule[i].interval;
+}
+
+/**
+ * Set Budget
+ *
+ * @param budget Bus time allowed per tick, in microseconds, at least one read is always allowed
+ * @param frequency I2C SCL frequency in Hz
+ */
+void LC709204FScheduler::setBudget(uint32_t budget, uint32_t frequency) {
+    uint32_t reads = (uint32_t)((uint64_t) budget * frequency / (1000000UL * LC709204F_READ_BITS));
+
+    _readsPerTick = reads < 1 ? 1 : reads > LC709204F_SCHEDULER_SIZE ? LC709204F_SCHEDULER_SIZE : reads;
+}
+
+/**
+ * Get Reads Per Tick
+ *
+ * @return Largest number of registers read by one tick()
+ */
+uint8_t LC709204FScheduler::getReadsPerTick(void) {
+    return _readsPerTick;
+}
+
+int8_t LC709204FScheduler::find(uint8_t command) {
+    for (uint8_t i = 0; i < LC709204F_SCHEDULER_SIZE; i++) {
+        if (_schedule[i].command != 0 && _schedule[i].command == command)
+            return i;
+    }
+    return -1;
+}
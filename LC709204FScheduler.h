@@ -0,0 +1,76 @@
+/**
+ * @file LC709204FScheduler.h
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Adaptive per-register polling of LC709204F registers
+ * @copyright MIT (see LICENSE.md)
+ */
+
+#ifndef _LC709204F_SCHEDULER_H
+#define _LC709204F_SCHEDULER_H
+
+#include "LC709204F.h"
+
+#ifndef LC709204F_SCHEDULER_SIZE
+#define LC709204F_SCHEDULER_SIZE 12 /// Number of registers a LC709204FScheduler can poll.
+#endif
+
+/**
+ * Polled register
+ */
+typedef struct {
+    uint8_t command;           /// Register polled, 0 for a free slot
+    bool valid;                /// value holds a successful read
+    uint16_t value;            /// Last value read
+    unsigned long due;         /// millis() when the next read is due
+    unsigned long interval;    /// Current polling interval, ms
+    unsigned long minInterval; /// Interval used while the register keeps changing, ms
+    unsigned long maxInterval; /// Interval reached while the register is stable, ms
+} lc709204f_schedule_t;
+
+/**
+ * Adaptive polling scheduler
+ *
+ * Every register has its own polling interval, between a minimum and a maximum. A read that
+ * finds the register changed halves it, a read that finds it unchanged grows it by half plus
+ * 1ms, so stable registers are read less and less often and moving ones quickly get read often
+ * again. tick() reads the registers that are due, most overdue first, within a bus time budget;
+ * the others stay due for the next tick.
+ *
+ *   LC709204FScheduler scheduler(batteryMonitor);
+ *   scheduler.addDefaults();
+ *   ...
+ *   scheduler.tick();
+ *   scheduler.getValue(LC709204F_REG_RSOC, &rsoc);
+ */
+class LC709204FScheduler {
+public:
+    LC709204FScheduler(LC709204F &gauge, uint32_t budget = 2000, uint32_t frequency = 100000);
+
+    int8_t add(uint8_t command, unsigned long minInterval, unsigned long maxInterval);
+
+    void addDefaults(void);
+
+    bool remove(uint8_t command);
+
+    uint8_t tick(void);
+
+    bool getValue(uint8_t command, uint16_t *value);
+
+    unsigned long getInterval(uint8_t command);
+
+    void setBudget(uint32_t budget, uint32_t frequency = 100000);
+
+    uint8_t getReadsPerTick(void);
+
+private:
+    LC709204F &_gauge;
+
+    uint8_t _readsPerTick;
+
+    lc709204f_schedule_t _schedule[LC709204F_SCHEDULER_SIZE];
+
+    int8_t find(uint8_t command);
+};
+
+#endif
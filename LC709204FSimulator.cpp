@@ -0,0 +1,488 @@
+/**
+ * @file LC709204FSimulator.cpp
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Register level LC709204F simulator for host builds (LC709204F_HOST_BUILD)
+ * @copyright MIT (see LICENSE.md)
+ */
+
+#include "LC709204FSimulator.h"
+
+#if defined(LC709204F_HOST_BUILD)
+
+#define R  LC709204F_SIM_ACCESS_READ
+#define W  LC709204F_SIM_ACCESS_WRITE
+#define RW (LC709204F_SIM_ACCESS_READ | LC709204F_SIM_ACCESS_WRITE)
+
+/**
+ * Access rights of every command, as listed with the LC709204F_REG_* definitions.
+ */
+static const uint8_t LC709204F_SIM_ACCESS[LC709204F_REG_COUNT] = {
+    0, 0, 0, R,      // 0x00 - 0x03 TimeToEmpty
+    W, R, RW, W,     // 0x04 - 0x07 BeforeRSOC, TimeToFull, TSENSE1ThermistorB, InitialRSOC
+    RW, R, RW, RW,   // 0x08 - 0x0B CellTemperature, CellVoltage, CurrentDirection, APA
+    RW, RW, RW, R,   // 0x0C - 0x0F APT, RSOC, TSENSE2ThermistorB, ITE
+    0, R, RW, RW,    // 0x10 - 0x13 ICVersion, ChangeOfTheParameter, AlarmLowRSOC
+    RW, RW, RW, R,   // 0x14 - 0x17 AlarmLowCellVoltage, ICPowerMode, StatusBit, CycleCount
+    0, RW, R, 0,     // 0x18 - 0x1B BatteryStatus, NumberOfTheParameter
+    RW, RW, RW, RW,  // 0x1C - 0x1F TerminationCurrentRate, EmptyCellVoltage, ITEOffset, AlarmHighCellVoltage
+    RW, RW, 0, 0,    // 0x20 - 0x23 AlarmLowTemperature, AlarmHighTemperature
+    RW, RW, RW, RW,  // 0x24 - 0x27 TotalRunTime, AccumulatedTemperature
+    RW, RW, RW, RW,  // 0x28 - 0x2B AccumulatedRSOC, MaximumCellVoltage, MinimumCellVoltage
+    RW, RW, 0, 0,    // 0x2C - 0x2F MaximumCellTemperature, MinimumCellTemperature
+    R, 0, R, 0,      // 0x30 - 0x33 AmbientTemperature, StateOfHealth
+    0, 0, R, R,      // 0x34 - 0x37 UserId
+};
+
+#undef R
+#undef W
+#undef RW
+
+/**
+ * LC709204FSimulator class
+ */
+LC709204FSimulator::LC709204FSimulator(uint8_t address) {
+    _address = address;
+    _nackCount = 0;
+    _crcErrorCount = 0;
+    _shortReadCount = 0;
+    _counterCommand = 0;
+    _counterStep = 0;
+    _alarmPin = 0xFF;
+    _settleTime = 0;
+    _wokeAt = 0;
+    _operateTime = 0;
+    _crcErrors = 0;
+    _nacks = 0;
+    memset(_registers, 0, sizeof(_registers));
+    powerOnReset();
+}
+
+/**
+ * Power On Reset
+ *
+ * Loads the initial register values of the datasheet, BatteryStatus reports 0x00C0.
+ */
+void LC709204FSimulator::powerOnReset(void) {
+    if (_registers[LC709204F_REG_IC_POWER_MODE] == LC709204F_POWER_MODE_OPERATE)
+        _operateTime += millis() - _wokeAt;
+
+    memset(_registers, 0, sizeof(_registers));
+    memset(_measurements, 0, sizeof(_measurements));
+
+    _registers[LC709204F_REG_TIME_TO_EMPTY] = 0xFFFF;
+    _registers[LC709204F_REG_TIME_TO_FULL] = 0xFFFF;
+    _registers[LC709204F_REG_TSENSE1_THERMISTOR_B] = 0x0D34;
+    _registers[LC709204F_REG_CELL_TEMPERATURE_TSENSE1] = 0x0BA6;
+    _registers[LC709204F_REG_CELL_VOLTAGE] = 3700;
+    _registers[LC709204F_REG_APT] = 0x001E;
+    _registers[LC709204F_REG_RSOC] = 50;
+    _registers[LC709204F_REG_TSENSE2_THERMISTOR_B] = 0x0D34;
+    _registers[LC709204F_REG_ITE] = 500;
+    _registers[LC709204F_REG_IC_POWER_MODE] = LC709204F_POWER_MODE_SLEEP;
+    _registers[LC709204F_REG_BATTERY_STATUS] = 0x00C0;
+    _registers[LC709204F_REG_TERMINATION_CURRENT_RATE] = 0x0002;
+    _registers[LC709204F_REG_MINIMUM_CELL_VOLTAGE] = 0x1388;
+    _registers[LC709204F_REG_MAXIMUM_CELL_TEMPERATURE_TSENSE1] = 0x0980;
+    _registers[LC709204F_REG_MINIMUM_CELL_TEMPERATURE_TSENSE1] = 0x0DCC;
+    _registers[LC709204F_REG_AMBIENT_TEMPERATURE_TSENSE2] = 0x0BA6;
+    _registers[LC709204F_REG_STATE_OF_HEALTH] = 0x0064;
+
+    _commandValid = false;
+    updateAlarms();
+}
+
+/**
+ * Get a register value, bypassing the I2C interface.
+ */
+uint16_t LC709204FSimulator::getRegister(uint8_t command) {
+    return command < LC709204F_REG_COUNT ? _registers[command] : 0;
+}
+
+/**
+ * Set a register value, bypassing the I2C interface and the access rights.
+ */
+void LC709204FSimulator::setRegister(uint8_t command, uint16_t value) {
+    if (command < LC709204F_REG_COUNT) {
+        _registers[command] = value;
+        updateAlarms();
+    }
+}
+
+/**
+ * Get the access rights of a register.
+ *
+ * @return LC709204F_SIM_ACCESS_* bits
+ */
+uint8_t LC709204FSimulator::getAccess(uint8_t command) {
+    return command < LC709204F_REG_COUNT ? LC709204F_SIM_ACCESS[command] : LC709204F_SIM_ACCESS_NONE;
+}
+
+/**
+ * NACK the next write transfers.
+ */
+void LC709204FSimulator::injectNack(uint16_t count) {
+    _nackCount = count;
+}
+
+/**
+ * Send a wrong CRC on the next read transfers.
+ */
+void LC709204FSimulator::injectCrcError(uint16_t count) {
+    _crcErrorCount = count;
+}
+
+/**
+ * Return less data than requested on the next read transfers.
+ */
+void LC709204FSimulator::injectShortRead(uint16_t count) {
+    _shortReadCount = count;
+}
+
+/**
+ * Advance a 32-bit counter on every master write, eg: TotalRunTime or AccumulatedRSOC,
+ * so that reads of its two 16-bit halves can see the lower 16bit carry.
+ *
+ * @param lower Command of the lower 16bit, the higher 16bit is the next command
+ * @param step Increment per transfer, 0 to stop the counter
+ */
+void LC709204FSimulator::runCounter(uint8_t lower, uint16_t step) {
+    _counterCommand = lower;
+    _counterStep = lower + 1 < LC709204F_REG_COUNT ? step : 0;
+}
+
+/**
+ * Connect ALARMB to a simulated GPIO pin. ALARMB is driven LOW while any alarm bit of
+ * BatteryStatus is set.
+ *
+ * @param pin Host GPIO pin, 0xFF to disconnect
+ */
+void LC709204FSimulator::setAlarmPin(uint8_t pin) {
+    if (_alarmPin != 0xFF)
+        Gpio.set(_alarmPin, HIGH);
+
+    _alarmPin = pin;
+    updateAlarms();
+}
+
+/**
+ * Set the value a measured register, eg: CellVoltage or RSOC, takes at the next measurement.
+ * It is applied on the next transfer in operational mode after the settle time; setting the
+ * same register again before that replaces the pending value.
+ */
+void LC709204FSimulator::setMeasurement(uint8_t command, uint16_t value) {
+    int8_t free = -1;
+
+    for (uint8_t i = 0; i < LC709204F_SIM_MEASUREMENTS; i++) {
+        if (_measurements[i].command == command) {
+            _measurements[i].value = value;
+            return;
+        }
+        if (_measurements[i].command == 0 && free < 0)
+            free = i;
+    }
+
+    if (free >= 0 && command != 0 && command < LC709204F_REG_COUNT) {
+        _measurements[free].command = command;
+        _measurements[free].value = value;
+    }
+}
+
+/**
+ * Set the time in ms between the switch to operational mode and the first measurement.
+ */
+void LC709204FSimulator::setSettleTime(unsigned long settle) {
+    _settleTime = settle;
+}
+
+/**
+ * Time in ms spent in operational mode.
+ */
+unsigned long LC709204FSimulator::getOperateTime(void) {
+    if (_registers[LC709204F_REG_IC_POWER_MODE] == LC709204F_POWER_MODE_OPERATE)
+        return _operateTime + millis() - _wokeAt;
+
+    return _operateTime;
+}
+
+/**
+ * Number of writes rejected because of a wrong CRC.
+ */
+uint32_t LC709204FSimulator::getCrcErrors(void) {
+    return _crcErrors;
+}
+
+/**
+ * Number of write transfers NACKed.
+ */
+uint32_t LC709204FSimulator::getNacks(void) {
+    return _nacks;
+}
+
+/**
+ * Master write: either a command byte followed by a repeated start read,
+ * or a command byte, 2 data bytes and the CRC.
+ */
+uint8_t LC709204FSimulator::receive(const uint8_t *buffer, size_t len, bool stop) {
+    (void) stop;
+    _commandValid = false;
+    measure();
+
+    if (_counterStep) {
+        uint32_t counter = (uint32_t) _registers[_counterCommand + 1] << 16 | _registers[_counterCommand];
+        counter += _counterStep;
+        _registers[_counterCommand] = (uint16_t) counter;
+        _registers[_counterCommand + 1] = (uint16_t)(counter >> 16);
+    }
+
+    if (_nackCount) {
+        _nackCount--;
+        _nacks++;
+        return 3;
+    }
+
+    if (len == 0 || buffer[0] >= LC709204F_REG_COUNT || !LC709204F_SIM_ACCESS[buffer[0]]) {
+        _nacks++;
+        return 3;
+    }
+
+    if (len == 1) {
+        _command = buffer[0];
+        _commandValid = true;
+        return 0;
+    }
+
+    if (len != 4 || !(LC709204F_SIM_ACCESS[buffer[0]] & LC709204F_SIM_ACCESS_WRITE)) {
+        _nacks++;
+        return 3;
+    }
+
+    uint8_t frame[4] = {(uint8_t)(_address * 2), buffer[0], buffer[1], buffer[2]};
+    if (crc8(frame, 4) != buffer[3]) {
+        _crcErrors++;
+        _nacks++;
+        return 3;
+    }
+
+    uint16_t value = buffer[1] | (buffer[2] << 8);
+
+    switch (buffer[0]) {
+        case LC709204F_REG_INITIAL_RSOC:
+            if (value == LC709204_INITIALIZE_RSOC_PARAM)
+                _registers[LC709204F_REG_RSOC] = 100;
+            break;
+        case LC709204F_REG_BEFORE_RSOC:
+            break;
+        case LC709204F_REG_IC_POWER_MODE:
+            if (value == LC709204F_POWER_MODE_OPERATE && _registers[buffer[0]] != value)
+                _wokeAt = millis();
+            else if (value != LC709204F_POWER_MODE_OPERATE && _registers[buffer[0]] == LC709204F_POWER_MODE_OPERATE)
+                _operateTime += millis() - _wokeAt;
+            _registers[buffer[0]] = value;
+            break;
+        default:
+            _registers[buffer[0]] = value;
+            break;
+    }
+
+    updateAlarms();
+    return 0;
+}
+
+/**
+ * Master read: the 2 data bytes of the last command and the CRC.
+ */
+size_t LC709204FSimulator::request(uint8_t *buffer, size_t len, bool stop) {
+    (void) stop;
+    measure();
+
+    if (!_commandValid || !(LC709204F_SIM_ACCESS[_command] & LC709204F_SIM_ACCESS_READ))
+        return 0;
+
+    _commandValid = false;
+
+    uint16_t value = _registers[_command];
+    uint8_t frame[6] = {(uint8_t)(_address * 2), _command, (uint8_t)(_address * 2 | 0x1), (uint8_t)(value & 0xFF), (uint8_t)(value >> 8), 0};
+    frame[5] = crc8(frame, 5);
+
+    if (_crcErrorCount) {
+        _crcErrorCount--;
+        frame[5] ^= 0xFF;
+    }
+
+    if (len > 3)
+        len = 3;
+
+    if (_shortReadCount && len) {
+        _shortReadCount--;
+        len--;
+    }
+
+    memcpy(buffer, frame + 3, len);
+    return len;
+}
+
+/**
+ * Reference bitwise CRC8 (polynomial 0x07), independent from the driver implementation.
+ */
+uint8_t LC709204FSimulator::crc8(const uint8_t *data, int len) {
+    uint8_t crc(0x00);
+
+    for (int j = len; j; --j) {
+        crc ^= *data++;
+
+        for (int i = 8; i; --i) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+/**
+ * Sets the alarm bits whose threshold is crossed and drives ALARMB. Alarm bits stay set
+ * until cleared by a BatteryStatus write, and are set again if the condition persists.
+ * A threshold of 0 disables its alarm.
+ */
+void LC709204FSimulator::updateAlarms(void) {
+    uint16_t voltage = _registers[LC709204F_REG_CELL_VOLTAGE];
+    uint16_t temperature = _registers[LC709204F_REG_CELL_TEMPERATURE_TSENSE1];
+    uint16_t threshold;
+    uint16_t &status = _registers[LC709204F_REG_BATTERY_STATUS];
+
+    if ((threshold = _registers[LC709204F_REG_ALARM_HIGH_CELL_VOLTAGE]) && voltage >= threshold)
+        status |= LC709204F_BATTERY_STATUS_HIGH_CELL_VOLTAGE;
+
+    if ((threshold = _registers[LC709204F_REG_ALARM_LOW_CELL_VOLTAGE]) && voltage <= threshold)
+        status |= LC709204F_BATTERY_STATUS_LOW_CELL_VOLTAGE;
+
+    if ((threshold = _registers[LC709204F_REG_ALARM_LOW_RSOC]) && _registers[LC709204F_REG_RSOC] <= threshold)
+        status |= LC709204F_BATTERY_STATUS_LOW_RSOC;
+
+    if ((threshold = _registers[LC709204F_REG_ALARM_HIGH_TEMPERATURE]) && temperature >= threshold)
+        status |= LC709204F_BATTERY_STATUS_HIGH_TEMPERATURE;
+
+    if ((threshold = _registers[LC709204F_REG_ALARM_LOW_TEMPERATURE]) && temperature <= threshold)
+        status |= LC709204F_BATTERY_STATUS_LOW_TEMPERATURE;
+
+    if (_alarmPin != 0xFF)
+        Gpio.set(_alarmPin, (status & LC709204F_BATTERY_STATUS_ALARMS) ? LOW : HIGH);
+}
+
+/**
+ * Applies the pending measurements when operational and settled.
+ */
+void LC709204FSimulator::measure(void) {
+    if (_registers[LC709204F_REG_IC_POWER_MODE] != LC709204F_POWER_MODE_OPERATE || millis() - _wokeAt < _settleTime)
+        return;
+
+    bool measured = false;
+
+    for (uint8_t i = 0; i < LC709204F_SIM_MEASUREMENTS; i++) {
+        if (_measurements[i].command != 0) {
+            _registers[_measurements[i].command] = _measurements[i].value;
+            _measurements[i].command = 0;
+            measured = true;
+        }
+    }
+
+    if (measured)
+        updateAlarms();
+}
+
+/**
+ * LC709204FSimulatedMux class
+ */
+LC709204FSimulatedMux::LC709204FSimulatedMux() {
+    _port.mux = this;
+    _mask = 0;
+    _selects = 0;
+    for (uint8_t i = 0; i < 8; i++) {
+        _devices[i] = NULL;
+    }
+}
+
+/**
+ * Connect a device to a channel.
+ */
+void LC709204FSimulatedMux::attach(uint8_t channel, LC709204FBusDevice *device) {
+    if (channel < 8)
+        _devices[channel] = device;
+}
+
+/**
+ * The port to attach to the host bus at the address of the devices behind the multiplexer.
+ */
+LC709204FBusDevice *LC709204FSimulatedMux::downstream(void) {
+    return &_port;
+}
+
+/**
+ * Get the channels currently enabled, one bit per channel.
+ */
+uint8_t LC709204FSimulatedMux::getChannelMask(void) {
+    return _mask;
+}
+
+/**
+ * Number of writes to the multiplexer control register.
+ */
+uint32_t LC709204FSimulatedMux::getSelects(void) {
+    return _selects;
+}
+
+/**
+ * Control register write, one byte with one bit per channel.
+ */
+uint8_t LC709204FSimulatedMux::receive(const uint8_t *buffer, size_t len, bool stop) {
+    (void) stop;
+
+    if (len != 1)
+        return 3;
+
+    _mask = buffer[0];
+    _selects++;
+    return 0;
+}
+
+/**
+ * Control register read.
+ */
+size_t LC709204FSimulatedMux::request(uint8_t *buffer, size_t len, bool stop) {
+    (void) stop;
+
+    if (len == 0)
+        return 0;
+
+    buffer[0] = _mask;
+    return 1;
+}
+
+/**
+ * The single device on the enabled channels, or NULL.
+ */
+LC709204FBusDevice *LC709204FSimulatedMux::selected(void) {
+    LC709204FBusDevice *device = NULL;
+
+    for (uint8_t i = 0; i < 8; i++) {
+        if ((_mask & (1 << i)) && _devices[i] != NULL) {
+            if (device != NULL)
+                return NULL;
+            device = _devices[i];
+        }
+    }
+    return device;
+}
+
+uint8_t LC709204FSimulatedMux::Port::receive(const uint8_t *buffer, size_t len, bool stop) {
+    LC709204FBusDevice *device = mux->selected();
+
+    return device != NULL ? device->receive(buffer, len, stop) : 2;
+}
+
+size_t LC709204FSimulatedMux::Port::request(uint8_t *buffer, size_t len, bool stop) {
+    LC709204FBusDevice *device = mux->selected();
+
+    return device != NULL ? device->request(buffer, len, stop) : 0;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,171 @@
+/**
+ * @file LC709204FSimulator.h
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Register level LC709204F simulator for host builds (LC709204F_HOST_BUILD)
+ * @copyright MIT (see LICENSE.md)
+ */
+
+#ifndef _LC709204F_SIMULATOR_H
+#define _LC709204F_SIMULATOR_H
+
+#include "LC709204F.h"
+
+#if defined(LC709204F_HOST_BUILD)
+
+#define LC709204F_SIM_ACCESS_NONE  0x00 /// Unknown command, NACKed
+#define LC709204F_SIM_ACCESS_READ  0x01 /// Register can be read
+#define LC709204F_SIM_ACCESS_WRITE 0x02 /// Register can be written
+
+#ifndef LC709204F_SIM_MEASUREMENTS
+#define LC709204F_SIM_MEASUREMENTS 8 /// Number of pending measurements a LC709204FSimulator holds.
+#endif
+
+/**
+ * Simulated LC709204F
+ *
+ * Attach it to the host TwoWire bus:
+ *
+ *   LC709204FSimulator gauge;
+ *   Wire.attach(LC709204F_I2CADDR, &gauge);
+ *
+ * Writes are NACKed when the CRC is wrong or the register is not writable, reads return
+ * no data when the register is not readable, and reads carry the CRC the real chip sends.
+ * Alarm thresholds set the BatteryStatus alarm bits, which drive ALARMB if setAlarmPin() is used.
+ * Measurements set with setMeasurement() only reach their registers in operational mode, once
+ * the settle time since the wake up has elapsed, like the real chip which does not measure while asleep.
+ */
+class LC709204FSimulator : public LC709204FBusDevice {
+public:
+    LC709204FSimulator(uint8_t address = LC709204F_I2CADDR);
+
+    void powerOnReset(void);
+
+    uint16_t getRegister(uint8_t command);
+
+    void setRegister(uint8_t command, uint16_t value);
+
+    uint8_t getAccess(uint8_t command);
+
+    void injectNack(uint16_t count = 1);
+
+    void injectCrcError(uint16_t count = 1);
+
+    void injectShortRead(uint16_t count = 1);
+
+    void runCounter(uint8_t lower, uint16_t step);
+
+    void setAlarmPin(uint8_t pin);
+
+    void setMeasurement(uint8_t command, uint16_t value);
+
+    void setSettleTime(unsigned long settle);
+
+    unsigned long getOperateTime(void);
+
+    uint32_t getCrcErrors(void);
+
+    uint32_t getNacks(void);
+
+    virtual uint8_t receive(const uint8_t *buffer, size_t len, bool stop);
+
+    virtual size_t request(uint8_t *buffer, size_t len, bool stop);
+
+private:
+    uint8_t _address;
+
+    uint16_t _registers[LC709204F_REG_COUNT];
+
+    uint8_t _command;
+
+    bool _commandValid;
+
+    uint16_t _nackCount;
+
+    uint16_t _crcErrorCount;
+
+    uint16_t _shortReadCount;
+
+    uint8_t _counterCommand;
+
+    uint16_t _counterStep;
+
+    uint8_t _alarmPin;
+
+    struct {
+        uint8_t command; /// Register measured, 0 for a free slot
+        uint16_t value;  /// Value it takes at the next measurement
+    } _measurements[LC709204F_SIM_MEASUREMENTS];
+
+    unsigned long _settleTime;
+
+    unsigned long _wokeAt;
+
+    unsigned long _operateTime;
+
+    uint32_t _crcErrors;
+
+    uint32_t _nacks;
+
+    uint8_t crc8(const uint8_t *data, int len);
+
+    void updateAlarms(void);
+
+    void measure(void);
+};
+
+/**
+ * Simulated TCA9548A I2C multiplexer
+ *
+ * Attach the multiplexer itself at its address, and its downstream port at the address
+ * of the devices behind it:
+ *
+ *   LC709204FSimulatedMux mux;
+ *   Wire.attach(LC709204F_MUX_I2CADDR, &mux);
+ *   Wire.attach(LC709204F_I2CADDR, mux.downstream());
+ *   mux.attach(0, &gauge0);
+ *   mux.attach(1, &gauge1);
+ *
+ * Transfers to the downstream port reach the device on the selected channel. No device or
+ * several devices on the selected channels is seen as a NACK.
+ */
+class LC709204FSimulatedMux : public LC709204FBusDevice {
+public:
+    LC709204FSimulatedMux();
+
+    void attach(uint8_t channel, LC709204FBusDevice *device);
+
+    LC709204FBusDevice *downstream(void);
+
+    uint8_t getChannelMask(void);
+
+    uint32_t getSelects(void);
+
+    virtual uint8_t receive(const uint8_t *buffer, size_t len, bool stop);
+
+    virtual size_t request(uint8_t *buffer, size_t len, bool stop);
+
+private:
+    class Port : public LC709204FBusDevice {
+    public:
+        LC709204FSimulatedMux *mux;
+
+        virtual uint8_t receive(const uint8_t *buffer, size_t len, bool stop);
+
+        virtual size_t request(uint8_t *buffer, size_t len, bool stop);
+    };
+
+    Port _port;
+
+    uint8_t _mask;
+
+    uint32_t _selects;
+
+    LC709204FBusDevice *_devices[8];
+
+    LC709204FBusDevice *selected(void);
+};
+
+#endif
+
+#endif
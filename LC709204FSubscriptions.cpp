@@ -0,0 +1,148 @@
+/**
+ * @file LC709204FSubscriptions.cpp
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Change notifications for LC709204F registers
+ * @copyright MIT (see LICENSE.md)
+ */
+
+#include "LC709204FSubscriptions.h"
+
+static_assert(LC709204F_SUBSCRIPTIONS_SIZE <= 127, "LC709204FSubscriptions handles are int8_t");
+
+/**
+ * LC709204FSubscriptions class
+ *
+ * @param gauge The LC709204F to watch
+ */
+LC709204FSubscriptions::LC709204FSubscriptions(LC709204F &gauge) : _gauge(gauge) {
+    _reads = 0;
+    for (uint8_t i = 0; i < LC709204F_SUBSCRIPTIONS_SIZE; i++) {
+        _subscriptions[i].command = 0;
+    }
+}
+
+/**
+ * Subscribe
+ *
+ * The callback is called by update() with the first value read, then each time the register
+ * moved by at least threshold from the value last reported. Small changes do not move the
+ * reference, so a slow drift is reported once it adds up to the threshold.
+ *
+ * @param command The register to watch, eg: LC709204F_REG_RSOC
+ * @param threshold Smallest change reported, in register units, 0 or 1 to report every change
+ * @param callback Function called on changes
+ * @param context Pointer passed back to the callback
+ * @return Handle, or -1 if all LC709204F_SUBSCRIPTIONS_SIZE slots are in use
+ */
+int8_t LC709204FSubscriptions::subscribe(uint8_t command, uint16_t threshold, lc709204f_change_callback_t callback, void *context) {
+    if (command == 0 || callback == NULL)
+        return -1;
+
+    for (uint8_t i = 0; i < LC709204F_SUBSCRIPTIONS_SIZE; i++) {
+        lc709204f_subscription_t &subscription = _subscriptions[i];
+
+        if (subscription.command != 0)
+            continue;
+
+        subscription.command = command;
+        subscription.reported = false;
+        subscription.threshold = threshold ? threshold : 1;
+        subscription.last = 0;
+        subscription.callback = callback;
+        subscription.context = context;
+        return i;
+    }
+    return -1;
+}
+
+/**
+ * Unsubscribe
+ *
+ * @param handle The handle returned by subscribe
+ * @return False if the handle is not subscribed
+ */
+bool LC709204FSubscriptions::unsubscribe(int8_t handle) {
+    if (handle < 0 || handle >= LC709204F_SUBSCRIPTIONS_SIZE || _subscriptions[handle].command == 0)
+        return false;
+
+    _subscriptions[handle].command = 0;
+    return true;
+}
+
+/**
+ * Update
+ *
+ * Reads every subscribed register once, however many subscriptions watch it, with one
+ * LC709204F::execute() call, and calls the callbacks of the subscriptions whose threshold was
+ * reached. Registers that fail to read are skipped until the next update.
+ *
+ * @return Number of callbacks called
+ */
+uint8_t LC709204FSubscriptions::update(void) {
+    lc709204f_batch_item_t items[LC709204F_SUBSCRIPTIONS_SIZE];
+    uint8_t item[LC709204F_SUBSCRIPTIONS_SIZE];
+    uint8_t dispatched = 0;
+
+    _reads = 0;
+
+    // One read per register, shared by all of its subscriptions
+    for (uint8_t i = 0; i < LC709204F_SUBSCRIPTIONS_SIZE; i++) {
+        uint8_t command = _subscriptions[i].command;
+        uint8_t j = 0;
+
+        item[i] = 0xFF;
+        if (command == 0)
+            continue;
+
+        while (j < _reads && items[j].command != command) {
+            j++;
+        }
+
+        if (j == _reads) {
+            items[j].command = command;
+            items[j].write = false;
+            _reads++;
+        }
+        item[i] = j;
+    }
+
+    if (_reads == 0)
+        return 0;
+
+    _gauge.execute(items, _reads);
+
+    for (uint8_t i = 0; i < LC709204F_SUBSCRIPTIONS_SIZE; i++) {
+        lc709204f_subscription_t &subscription = _subscriptions[i];
+
+        // Free, or subscribed by a callback of this update
+        if (item[i] == 0xFF || subscription.command != items[item[i]].command)
+            continue;
+
+        const lc709204f_batch_item_t &result = items[item[i]];
+
+        if (result.status != LC709204F_STATUS_OK)
+            continue;
+
+        uint16_t change = result.value > subscription.last ? result.value - subscription.last : subscription.last - result.value;
+
+        if (subscription.reported && change < subscription.threshold)
+            continue;
+
+        uint16_t previous = subscription.reported ? subscription.last : result.value;
+        subscription.last = result.value;
+        subscription.reported = true;
+        subscription.callback(i, result.value, previous, subscription.context);
+        dispatched++;
+    }
+    return dispatched;
+}
+
+/**
+ * Get Reads
+ *
+ * @return Number of registers read by the last update()
+ */
+uint8_t LC709204FSubscriptions::getReads(void) {
+    return _reads;
+}
@@ -0,0 +1,69 @@
+/**
+ * @file LC709204FSubscriptions.h
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Change notifications for LC709204F registers
+ * @copyright MIT (see LICENSE.md)
+ */
+
+#ifndef _LC709204F_SUBSCRIPTIONS_H
+#define _LC709204F_SUBSCRIPTIONS_H
+
+#include "LC709204F.h"
+
+#ifndef LC709204F_SUBSCRIPTIONS_SIZE
+#define LC709204F_SUBSCRIPTIONS_SIZE 8 /// Number of subscriptions a LC709204FSubscriptions can hold.
+#endif
+
+/**
+ * Change callback
+ *
+ * @param handle The handle returned by subscribe
+ * @param value The new register value, in register units
+ * @param previous The value last reported for this subscription, equal to value on the first report
+ * @param context The context pointer passed to subscribe
+ */
+typedef void (*lc709204f_change_callback_t)(int8_t handle, uint16_t value, uint16_t previous, void *context);
+
+/**
+ * Subscription slot
+ */
+typedef struct {
+    uint8_t command;                      /// Register watched, 0 for a free slot
+    bool reported;                        /// A value was reported already
+    uint16_t threshold;                   /// Smallest change reported
+    uint16_t last;                        /// Value last reported
+    lc709204f_change_callback_t callback;
+    void *context;
+} lc709204f_subscription_t;
+
+/**
+ * Change notifications
+ *
+ *   LC709204FSubscriptions subscriptions(batteryMonitor);
+ *   subscriptions.subscribe(LC709204F_REG_RSOC, 1, onRSOCChange);
+ *   subscriptions.subscribe(LC709204F_REG_CELL_VOLTAGE, 20, onVoltageChange);
+ *   ...
+ *   subscriptions.update();
+ */
+class LC709204FSubscriptions {
+public:
+    LC709204FSubscriptions(LC709204F &gauge);
+
+    int8_t subscribe(uint8_t command, uint16_t threshold, lc709204f_change_callback_t callback, void *context = NULL);
+
+    bool unsubscribe(int8_t handle);
+
+    uint8_t update(void);
+
+    uint8_t getReads(void);
+
+private:
+    LC709204F &_gauge;
+
+    lc709204f_subscription_t _subscriptions[LC709204F_SUBSCRIPTIONS_SIZE];
+
+    uint8_t _reads;
+};
+
+#endif
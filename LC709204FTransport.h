@@ -0,0 +1,471 @@
+/**
+ * @file LC709204FTransport.h
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Compile time I2C transport policies of the LC709204F driver
+ * @copyright MIT (see LICENSE.md)
+ */
+
+#ifndef _LC709204F_TRANSPORT_H
+#define _LC709204F_TRANSPORT_H
+
+#if defined(LC709204F_HOST_BUILD)
+#include "LC709204FHost.h"
+#else
+#include "Arduino.h"
+#if !defined(LC709204F_TRANSPORT_TINYWIREM)
+#include "Wire.h"
+#endif
+#endif
+
+/**
+ * Bus selection
+ *
+ * The driver is compiled for one bus class, resolved at compile time so that every transfer is
+ * a direct, inlinable call:
+ * - default: Arduino TwoWire (also megaAVR Wire, and the host TwoWire of LC709204F_HOST_BUILD)
+ * - TinyWireM (USI_TWI) on ATtiny: -DLC709204F_TRANSPORT_TINYWIREM
+ * - ESP-IDF i2c_master driver: -DLC709204F_TRANSPORT_IDF, pass the i2c_master_bus_handle_t to the constructor
+ * - Linux i2c-dev: -DLC709204F_HOST_BUILD -DLC709204F_TRANSPORT_LINUX, see LC709204FLinux.h
+ * - any class with the TwoWire API, eg: a test fake declared in MyBus.h:
+ *   -DLC709204F_BUS_HEADER=\"MyBus.h\" -DLC709204F_BUS=MyBus -DLC709204F_DEFAULT_BUS=\&myBus
+ *   The header is included by every file of the library, it must declare MyBus and myBus.
+ */
+#if defined(LC709204F_BUS_HEADER)
+#include LC709204F_BUS_HEADER
+#endif
+
+#if defined(LC709204F_TRANSPORT_TINYWIREM)
+#include "TinyWireM.h"
+#define LC709204F_BUS USI_TWI
+#define LC709204F_DEFAULT_BUS &TinyWireM
+#endif
+
+#if defined(LC709204F_TRANSPORT_LINUX)
+#include "LC709204FLinux.h"
+#define LC709204F_BUS LC709204FLinuxI2C
+#define LC709204F_DEFAULT_BUS &LinuxI2C
+#endif
+
+#if defined(LC709204F_TRANSPORT_IDF)
+#include <string.h>
+#include "driver/i2c_master.h"
+#define LC709204F_BUS i2c_master_bus_t
+#define LC709204F_DEFAULT_BUS NULL
+#endif
+
+#ifndef LC709204F_BUS
+#define LC709204F_BUS TwoWire
+#endif
+
+#ifndef LC709204F_DEFAULT_BUS
+#define LC709204F_DEFAULT_BUS &Wire
+#endif
+
+#define LC709204F_TRANSPORT_SHORT_READ 6 /// transfer() code: a reply was shorter than requested.
+
+/**
+ * Transfer descriptor: a write, optionally followed by a read after a repeated START
+ */
+typedef struct {
+    const uint8_t *write; /// Bytes to write, the register command first
+    uint8_t writeLen;     /// Number of bytes to write
+    uint8_t *read;        /// Reply buffer, NULL for a plain write
+    uint8_t readLen;      /// Number of bytes to read
+} lc709204f_transfer_t;
+
+/**
+ * Transport policy
+ *
+ * The driver needs three operations:
+ * - write(): START, address, data, STOP if stop is true; returns the endTransmission() code:
+ *   0 success, 1 data too long, 2 address NACK, 3 data NACK, 4 other error, 5 timeout
+ * - read(): START (repeated if the previous write had no STOP), address, data; returns the
+ *   number of bytes received
+ * - transfer(): a sequence of lc709204f_transfer_t; returns the code of the first failure
+ *   (LC709204F_TRANSPORT_SHORT_READ for a short reply), 0 if all completed, and the number of
+ *   transfers completed in done. Transports able to queue transfers send the whole sequence
+ *   as one transaction, joined by repeated STARTs.
+ *
+ * This generic policy forwards them to a class with the Wire API.
+ */
+template<class Bus>
+class LC709204FTransport {
+public:
+    typedef Bus bus_t;
+
+    LC709204FTransport(Bus *bus) : _bus(bus) {}
+
+    void begin(void) {
+        _bus->begin();
+    }
+
+    uint8_t write(uint8_t address, const uint8_t *buffer, size_t len, bool stop) {
+        _bus->beginTransmission(address);
+
+        if (_bus->write(buffer, len) != len)
+            return 1;
+
+        return _bus->endTransmission(stop);
+    }
+
+    size_t read(uint8_t address, uint8_t *buffer, size_t len, bool stop) {
+#if defined(ARDUINO_ARCH_MEGAAVR)
+        size_t recv = _bus->requestFrom(address, len, stop);
+#else
+        size_t recv = _bus->requestFrom(address, (uint8_t) len, (uint8_t) stop);
+#endif
+
+        if (recv != len)
+            return recv;
+
+        for (size_t i = 0; i < len; i++) {
+            buffer[i] = _bus->read();
+        }
+        return len;
+    }
+
+    uint8_t transfer(uint8_t address, const lc709204f_transfer_t *transfers, size_t count, size_t *done) {
+        for (*done = 0; *done < count; (*done)++) {
+            const lc709204f_transfer_t &t = transfers[*done];
+            uint8_t code = write(address, t.write, t.writeLen, t.read == NULL);
+
+            if (code != 0)
+                return code;
+
+            if (t.read != NULL && read(address, t.read, t.readLen, true) != t.readLen)
+                return LC709204F_TRANSPORT_SHORT_READ;
+        }
+        return 0;
+    }
+
+private:
+    Bus *_bus;
+};
+
+#if defined(LC709204F_TRANSPORT_TINYWIREM)
+
+/**
+ * TinyWireM policy
+ *
+ * USI_TWI has no multi-byte write taking a const buffer and its requestFrom() returns a status,
+ * not a count: the bytes are written one by one and counted with available(). A write without
+ * STOP leaves the bus to the repeated START of the next requestFrom().
+ */
+template<>
+class LC709204FTransport<USI_TWI> {
+public:
+    typedef USI_TWI bus_t;
+
+    LC709204FTransport(USI_TWI *bus) : _bus(bus) {}
+
+    void begin(void) {
+        _bus->begin();
+    }
+
+    uint8_t write(uint8_t address, const uint8_t *buffer, size_t len, bool stop) {
+        _bus->beginTransmission(address);
+
+        for (size_t i = 0; i < len; i++) {
+            if (_bus->write(buffer[i]) != 1)
+                return 1;
+        }
+
+        return _bus->endTransmission((uint8_t) stop);
+    }
+
+    size_t read(uint8_t address, uint8_t *buffer, size_t len, bool stop) {
+        (void) stop;
+
+        if (_bus->requestFrom(address, (uint8_t) len) != 0)
+            return 0;
+
+        size_t recv = _bus->available();
+
+        if (recv != len)
+            return recv;
+
+        for (size_t i = 0; i < len; i++) {
+            buffer[i] = _bus->read();
+        }
+        return len;
+    }
+
+    uint8_t transfer(uint8_t address, const lc709204f_transfer_t *transfers, size_t count, size_t *done) {
+        for (*done = 0; *done < count; (*done)++) {
+            const lc709204f_transfer_t &t = transfers[*done];
+            uint8_t code = write(address, t.write, t.writeLen, t.read == NULL);
+
+            if (code != 0)
+                return code;
+
+            if (t.read != NULL && read(address, t.read, t.readLen, true) != t.readLen)
+                return LC709204F_TRANSPORT_SHORT_READ;
+        }
+        return 0;
+    }
+
+private:
+    USI_TWI *_bus;
+};
+
+#endif
+
+#if defined(LC709204F_TRANSPORT_IDF)
+
+#ifndef LC709204F_IDF_SCL_SPEED
+#define LC709204F_IDF_SCL_SPEED 100000 /// SCL frequency of the LC709204F device on the i2c_master bus, Hz.
+#endif
+
+#ifndef LC709204F_IDF_TIMEOUT
+#define LC709204F_IDF_TIMEOUT 50 /// i2c_master transfer timeout, ms.
+#endif
+
+/**
+ * ESP-IDF i2c_master policy
+ *
+ * The i2c_master driver has no write without STOP: a write without STOP is kept and sent
+ * together with the next read as one i2c_master_transmit_receive() transaction, which has
+ * the repeated START the LC709204F expects. A NACK of such a write is reported by the read.
+ */
+template<>
+class LC709204FTransport<i2c_master_bus_t> {
+public:
+    typedef i2c_master_bus_t bus_t;
+
+    LC709204FTransport(i2c_master_bus_handle_t bus) : _bus(bus), _device(NULL), _address(0xFF), _pendingLen(0) {}
+
+    void begin(void) {}
+
+    uint8_t write(uint8_t address, const uint8_t *buffer, size_t len, bool stop) {
+        if (!select(address))
+            return 4;
+
+        if (!stop) {
+            if (len > sizeof(_pending))
+                return 1;
+
+            memcpy(_pending, buffer, len);
+            _pendingLen = len;
+            return 0;
+        }
+
+        _pendingLen = 0;
+
+        switch (i2c_master_transmit(_device, buffer, len, LC709204F_IDF_TIMEOUT)) {
+            case ESP_OK:
+                return 0;
+            case ESP_ERR_TIMEOUT:
+                return 5;
+            case ESP_FAIL:
+            case ESP_ERR_INVALID_STATE:
+                return 2;
+            default:
+                return 4;
+        }
+    }
+
+    size_t read(uint8_t address, uint8_t *buffer, size_t len, bool stop) {
+        (void) stop;
+        esp_err_t err;
+
+        if (!select(address))
+            return 0;
+
+        if (_pendingLen) {
+            err = i2c_master_transmit_receive(_device, _pending, _pendingLen, buffer, len, LC709204F_IDF_TIMEOUT);
+        } else {
+            err = i2c_master_receive(_device, buffer, len, LC709204F_IDF_TIMEOUT);
+        }
+
+        _pendingLen = 0;
+        return err == ESP_OK ? len : 0;
+    }
+
+    uint8_t transfer(uint8_t address, const lc709204f_transfer_t *transfers, size_t count, size_t *done) {
+        for (*done = 0; *done < count; (*done)++) {
+            const lc709204f_transfer_t &t = transfers[*done];
+            uint8_t code = write(address, t.write, t.writeLen, t.read == NULL);
+
+            if (code != 0)
+                return code;
+
+            if (t.read != NULL && read(address, t.read, t.readLen, true) != t.readLen)
+                return LC709204F_TRANSPORT_SHORT_READ;
+        }
+        return 0;
+    }
+
+private:
+    i2c_master_bus_handle_t _bus;
+
+    i2c_master_dev_handle_t _device;
+
+    uint8_t _address;
+
+    uint8_t _pending[4];
+
+    size_t _pendingLen;
+
+    /**
+     * Adds the device at address to the bus, the previous one is removed.
+     */
+    bool select(uint8_t address) {
+        if (address == _address && _device != NULL)
+            return true;
+
+        if (_device != NULL) {
+            i2c_master_bus_rm_device(_device);
+            _device = NULL;
+        }
+
+        i2c_device_config_t config;
+        memset(&config, 0, sizeof(config));
+        config.dev_addr_length = I2C_ADDR_BIT_LEN_7;
+        config.device_address = address;
+        config.scl_speed_hz = LC709204F_IDF_SCL_SPEED;
+
+        if (_bus == NULL || i2c_master_bus_add_device(_bus, &config, &_device) != ESP_OK) {
+            _device = NULL;
+            return false;
+        }
+
+        _address = address;
+        return true;
+    }
+};
+
+#endif
+
+#if defined(LC709204F_TRANSPORT_LINUX)
+
+/**
+ * Linux i2c-dev policy
+ *
+ * Every transfer is one I2C_RDWR ioctl. A write without STOP is kept and sent together with
+ * the next read, as a write message and a read message joined by a repeated START: one system
+ * call per register read. transfer() puts as many transfers as LC709204F_LINUX_MAX_MESSAGES
+ * allows in each ioctl, with at most one write, last: when the ioctl fails, only its reads are
+ * retried to find the failed transfer, so that no write, eg: InitialRSOC, is ever repeated.
+ */
+template<>
+class LC709204FTransport<LC709204FLinuxI2C> {
+public:
+    typedef LC709204FLinuxI2C bus_t;
+
+    LC709204FTransport(LC709204FLinuxI2C *bus) : _bus(bus), _pendingLen(0) {}
+
+    void begin(void) {
+        _bus->begin();
+    }
+
+    uint8_t write(uint8_t address, const uint8_t *buffer, size_t len, bool stop) {
+        if (!stop) {
+            if (len > sizeof(_pending))
+                return 1;
+
+            memcpy(_pending, buffer, len);
+            _pendingLen = len;
+            return 0;
+        }
+
+        struct i2c_msg message = {address, 0, (uint16_t) len, (uint8_t *) buffer};
+
+        _pendingLen = 0;
+        return code(_bus->transfer(&message, 1));
+    }
+
+    size_t read(uint8_t address, uint8_t *buffer, size_t len, bool stop) {
+        (void) stop;
+        struct i2c_msg messages[2];
+        uint32_t count = 0;
+
+        if (_pendingLen) {
+            messages[count++] = {address, 0, (uint16_t) _pendingLen, _pending};
+        }
+        messages[count++] = {address, I2C_M_RD, (uint16_t) len, buffer};
+
+        _pendingLen = 0;
+        return _bus->transfer(messages, count) == 0 ? len : 0;
+    }
+
+    uint8_t transfer(uint8_t address, const lc709204f_transfer_t *transfers, size_t count, size_t *done) {
+        struct i2c_msg messages[LC709204F_LINUX_MAX_MESSAGES];
+
+        for (*done = 0; *done < count;) {
+            uint32_t n = 0;
+            size_t batch = 0;
+
+            // As many transfers as fit in one ioctl, 2 messages for a read, a write ends it
+            for (; *done + batch < count; batch++) {
+                const lc709204f_transfer_t &t = transfers[*done + batch];
+
+                if (n + (t.read != NULL ? 2 : 1) > LC709204F_LINUX_MAX_MESSAGES)
+                    break;
+
+                messages[n++] = {address, 0, t.writeLen, (uint8_t *) t.write};
+                if (t.read != NULL)
+                    messages[n++] = {address, I2C_M_RD, t.readLen, t.read};
+
+                if (t.read == NULL) {
+                    batch++;
+                    break;
+                }
+            }
+
+            int error = _bus->transfer(messages, n);
+
+            if (error && batch > 1) {
+                // The kernel does not tell which message failed: the reads are sent again one
+                // by one to find it. A write is never sent twice: if the reads all pass now, it
+                // is reported as failed, whether it reached the chip or not.
+                size_t reads = transfers[*done + batch - 1].read == NULL ? batch - 1 : batch;
+
+                for (size_t end = *done + reads; *done < end; (*done)++) {
+                    size_t single;
+                    uint8_t result = transfer(address, transfers + *done, 1, &single);
+
+                    if (result != 0)
+                        return result;
+                }
+
+                if (reads == batch)
+                    continue;
+            }
+
+            if (error)
+                return code(error);
+
+            *done += batch;
+        }
+        return 0;
+    }
+
+private:
+    LC709204FLinuxI2C *_bus;
+
+    uint8_t _pending[4];
+
+    size_t _pendingLen;
+
+    /**
+     * errno of a failed transfer to a Wire code.
+     */
+    static uint8_t code(int error) {
+        switch (error) {
+            case 0:
+                return 0;
+            case ENXIO:
+            case EREMOTEIO:
+                return 2;
+            case ETIMEDOUT:
+                return 5;
+            default:
+                return 4;
+        }
+    }
+};
+
+#endif
+
+#endif
@@ -0,0 +1,66 @@
+/**
+ * @file LC709204F_alarm.ino
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details LC709204F Battery Monitor interrupt driven alarm example
+ * @copyright MIT (see LICENSE.md)
+ */
+
+#include "LC709204F.h"
+#include "LC709204FAlarm.h"
+
+#define ALARMB_PIN 4 // GPIO connected to the ALARMB output of the LC709204F
+
+LC709204F batteryMonitor;
+LC709204FAlarm alarm(batteryMonitor);
+
+bool initBatteryMonitor() {
+    return batteryMonitor.init(
+            lc709204f_apa_adjustment_t::LC709204F_APA_1000MAH, // 1000 mAh cell
+            lc709204f_battery_profile_t::LC709204F_BATTERY_PROFILE_3_7_V); // 3.7V cell, charging at 4.2V
+}
+
+void onAlarm(uint16_t alarms, uint16_t status, void *context) {
+    if (alarms & LC709204F_BATTERY_STATUS_INITIALIZED) {
+        Serial.println("Power on reset, initializing again.");
+        initBatteryMonitor();
+    }
+
+    if (alarms & LC709204F_BATTERY_STATUS_LOW_RSOC)
+        Serial.println("Low RSOC alarm.");
+
+    if (alarms & LC709204F_BATTERY_STATUS_LOW_CELL_VOLTAGE)
+        Serial.println("Low cell voltage alarm.");
+
+    if (alarms & LC709204F_BATTERY_STATUS_HIGH_CELL_VOLTAGE)
+        Serial.println("High cell voltage alarm.");
+
+    if (alarms & (LC709204F_BATTERY_STATUS_LOW_TEMPERATURE | LC709204F_BATTERY_STATUS_HIGH_TEMPERATURE))
+        Serial.println("Temperature alarm.");
+}
+
+void setup() {
+    Serial.begin(115200);
+    delay(10);
+    Serial.println("\nLC709204F alarm demo.");
+
+    if (!initBatteryMonitor()) {
+        Serial.println("Couldn't find LC709204F battery monitor!");
+        while (1) delay(1000);
+    }
+
+    batteryMonitor.setAlarmLowRSOC(10);          // 10%
+    batteryMonitor.setAlarmLowCellVoltage(3300); // 3.3V
+
+    if (!alarm.begin(ALARMB_PIN, onAlarm)) {
+        Serial.println("Couldn't attach the ALARMB interrupt!");
+        while (1) delay(1000);
+    }
+}
+
+void loop() {
+    // Reads from the LC709204F only after ALARMB fired
+    alarm.update();
+
+    delay(10);
+}
@@ -0,0 +1,181 @@
+/**
+ * @file actortest.cpp
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Multi-threaded stress test of LC709204FActor against the host simulator
+ * @copyright MIT (see LICENSE.md)
+ *
+ * Build and run from the library folder:
+ *   g++ -O2 -pthread -DLC709204F_HOST_BUILD -I. extras/actortest/actortest.cpp *.cpp -o lc709204f_actortest
+ *   ./lc709204f_actortest [iterations]
+ *
+ * Add -fsanitize=thread to look for data races as well. The shadow register file and write
+ * elision are on throughout. Prints one line per failed check, the exit code is 1 if any failed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <thread>
+#include "LC709204F.h"
+#include "LC709204FActor.h"
+#include "LC709204FSimulator.h"
+
+#define WRITERS 4 /// Threads writing and reading back a register of their own
+#define READERS 4 /// Threads reading measurements and writing a shared register
+
+static LC709204FSimulator gauge;
+static LC709204F batteryMonitor;
+static LC709204FActor actor(batteryMonitor);
+static std::atomic<int> failures(0);
+static std::atomic<int> callbacks(0);
+
+static const uint8_t OWN_REGISTERS[WRITERS] = {
+    LC709204F_REG_TSENSE1_THERMISTOR_B,
+    LC709204F_REG_APT,
+    LC709204F_REG_TSENSE2_THERMISTOR_B,
+    LC709204F_REG_EMPTY_CELL_VOLTAGE,
+};
+
+static const uint8_t SHARED_REGISTER = LC709204F_REG_ALARM_LOW_CELL_VOLTAGE;
+
+#define CHECK(condition)                                               \
+    do {                                                               \
+        if (!(condition)) {                                            \
+            printf("%s:%d: %s\n", __FILE__, __LINE__, #condition);     \
+            failures++;                                                \
+        }                                                              \
+    } while (0)
+
+/**
+ * Callback of a read, context points to the expected value.
+ */
+static void onRead(lc709204f_result_t result, void *context) {
+    CHECK(result.status == LC709204F_STATUS_OK);
+    CHECK(result.value == *(const uint16_t *) context);
+    callbacks++;
+}
+
+/**
+ * Callback storing the result of a read, context points to a lc709204f_result_t.
+ */
+static void storeResult(lc709204f_result_t result, void *context) {
+    *(lc709204f_result_t *) context = result;
+}
+
+/**
+ * Conflicting writes from different threads, in a known order, sent with one run(): A writes a
+ * new value, B writes the previous one back, C reads it. The read and the chip must see B's write.
+ */
+static void orderedConflicts(unsigned long rounds) {
+    for (unsigned long i = 0; i < rounds; i++) {
+        uint16_t old = gauge.getRegister(SHARED_REGISTER);
+        uint16_t value = 2500 + i % 1000;
+        lc709204f_result_t readBack = {0, LC709204F_STATUS_BUS_ERROR};
+
+        if (value == old)
+            value++;
+
+        std::thread([value] { CHECK(actor.submitWrite(SHARED_REGISTER, value)); }).join();
+        std::thread([old] { CHECK(actor.submitWrite(SHARED_REGISTER, old)); }).join();
+        std::thread([&readBack] { CHECK(actor.submitRead(SHARED_REGISTER, storeResult, &readBack)); }).join();
+
+        CHECK(actor.run(0));
+        CHECK(readBack.status == LC709204F_STATUS_OK);
+        CHECK(readBack.value == old);
+        CHECK(gauge.getRegister(SHARED_REGISTER) == old);
+    }
+}
+
+/**
+ * Writes its own register and reads it back: the read must return the write, whatever the
+ * other threads queue in between.
+ */
+static void writer(int index, unsigned long iterations) {
+    uint8_t command = OWN_REGISTERS[index];
+
+    for (unsigned long i = 0; i < iterations; i++) {
+        uint16_t value = 3000 + (i * 7 + index) % 200;
+        lc709204f_result_t result = actor.write(command, value, 1000);
+
+        CHECK(result.status == LC709204F_STATUS_OK);
+
+        result = actor.read(command, 1000);
+        CHECK(result.status == LC709204F_STATUS_OK);
+        CHECK(result.value == value);
+
+        // Refused when the queue is full, which is fine here
+        actor.submitWrite(SHARED_REGISTER, 2500 + index);
+    }
+}
+
+/**
+ * Reads measurements, blocking and with callbacks, and writes the shared register.
+ */
+static void reader(int index, unsigned long iterations, const uint16_t *voltage, const uint16_t *rsoc) {
+    for (unsigned long i = 0; i < iterations; i++) {
+        lc709204f_result_t result;
+
+        switch ((i + index) % 3) {
+            case 0:
+                result = actor.read(LC709204F_REG_CELL_VOLTAGE, 1000);
+                CHECK(result.status == LC709204F_STATUS_OK);
+                CHECK(result.value == *voltage);
+                break;
+            case 1:
+                while (!actor.submitRead(LC709204F_REG_RSOC, onRead, (void *) rsoc)) {
+                    std::this_thread::yield();
+                }
+                break;
+            default:
+                result = actor.write(SHARED_REGISTER, 2600 + index, 1000);
+                CHECK(result.status == LC709204F_STATUS_OK);
+                break;
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    unsigned long iterations = argc > 1 ? strtoul(argv[1], NULL, 10) : 2000;
+
+    Wire.attach(LC709204F_I2CADDR, &gauge);
+    batteryMonitor.enableShadow();
+    batteryMonitor.setWriteElision(true);
+    CHECK(batteryMonitor.refreshShadow());
+
+    orderedConflicts(iterations / 10 + 1);
+
+    static uint16_t voltage = gauge.getRegister(LC709204F_REG_CELL_VOLTAGE);
+    static uint16_t rsoc = gauge.getRegister(LC709204F_REG_RSOC);
+    std::thread owner(LC709204FActor::task, &actor);
+    std::thread threads[WRITERS + READERS];
+
+    for (int i = 0; i < WRITERS; i++) {
+        threads[i] = std::thread(writer, i, iterations);
+    }
+    for (int i = 0; i < READERS; i++) {
+        threads[WRITERS + i] = std::thread(reader, i, iterations, &voltage, &rsoc);
+    }
+    for (int i = 0; i < WRITERS + READERS; i++) {
+        threads[i].join();
+    }
+
+    // The shadow (served by the actor) and the chip agree on the shared register
+    lc709204f_result_t shared = actor.read(SHARED_REGISTER, 1000);
+    CHECK(shared.status == LC709204F_STATUS_OK);
+
+    actor.stop();
+    owner.join();
+
+    CHECK(shared.value == gauge.getRegister(SHARED_REGISTER));
+    for (int i = 0; i < WRITERS; i++) {
+        CHECK(gauge.getRegister(OWN_REGISTERS[i]) == 3000 + ((iterations - 1) * 7 + i) % 200);
+    }
+
+    lc709204f_actor_stats_t stats = actor.getStats();
+
+    printf("submitted %u, coalesced %u, executed %u in %u batches, rejected %u, timeouts %u, callbacks %d\n",
+           stats.submitted, stats.coalesced, stats.executed, stats.batches, stats.rejected, stats.timeouts, callbacks.load());
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,177 @@
+/**
+ * @file alarmtest.cpp
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Checks LC709204FAlarm against the ALARMB pin of the host simulator
+ * @copyright MIT (see LICENSE.md)
+ *
+ * Build and run from the library folder:
+ *   g++ -O2 -DLC709204F_HOST_BUILD -I. extras/alarmtest/alarmtest.cpp *.cpp -o lc709204f_alarmtest
+ *   ./lc709204f_alarmtest
+ *
+ * Prints one line per failed check, the exit code is 1 if any failed.
+ */
+
+#include <stdio.h>
+#include "LC709204F.h"
+#include "LC709204FAlarm.h"
+#include "LC709204FSimulator.h"
+
+#define ALARMB_PIN 2 /// Simulated GPIO wired to ALARMB
+#define HOLDOFF 20   /// Holdoff used by the tests, ms
+
+static LC709204FSimulator gauge;
+static LC709204F batteryMonitor;
+static int failures = 0;
+
+#define CHECK(condition)                                               \
+    do {                                                               \
+        if (!(condition)) {                                            \
+            printf("%s:%d: %s\n", __FILE__, __LINE__, #condition);     \
+            failures++;                                                \
+        }                                                              \
+    } while (0)
+
+/**
+ * Alarms reported to the callback
+ */
+typedef struct {
+    int calls;
+    uint16_t alarms;
+    uint16_t status;
+} report_t;
+
+static void onAlarm(uint16_t alarms, uint16_t status, void *context) {
+    report_t *report = (report_t *) context;
+
+    report->calls++;
+    report->alarms = alarms;
+    report->status = status;
+}
+
+/**
+ * Nothing pending: the first update() after begin() reads BatteryStatus once.
+ */
+static void quiet(LC709204FAlarm &alarm, report_t &report) {
+    gauge.setRegister(LC709204F_REG_BATTERY_STATUS, 0);
+    CHECK(alarm.begin(ALARMB_PIN, onAlarm, &report));
+    CHECK(alarm.update());
+    CHECK(report.calls == 0 && alarm.getAlarms() == 0);
+
+    uint32_t issued = batteryMonitor.getIssuedReads();
+    CHECK(!alarm.update());
+    CHECK(batteryMonitor.getIssuedReads() == issued);
+}
+
+/**
+ * RSOC crosses AlarmLowRSOC and comes back: ALARMB falls once, the callback fires once with
+ * the alarm bit, the bit is cleared and ALARMB is released.
+ */
+static void single(LC709204FAlarm &alarm, report_t &report) {
+    gauge.setRegister(LC709204F_REG_RSOC, 50);
+    gauge.setRegister(LC709204F_REG_ALARM_LOW_RSOC, 10);
+    CHECK(Gpio.get(ALARMB_PIN) == HIGH);
+
+    gauge.setRegister(LC709204F_REG_RSOC, 8);
+    CHECK(Gpio.get(ALARMB_PIN) == LOW);
+    CHECK(alarm.getInterrupts() == 1);
+
+    // The bit is latched until cleared
+    gauge.setRegister(LC709204F_REG_RSOC, 12);
+
+    CHECK(alarm.update());
+    CHECK(report.calls == 1);
+    CHECK(report.alarms == LC709204F_BATTERY_STATUS_LOW_RSOC);
+    CHECK(alarm.getAlarms() == LC709204F_BATTERY_STATUS_LOW_RSOC);
+    CHECK((gauge.getRegister(LC709204F_REG_BATTERY_STATUS) & LC709204F_BATTERY_STATUS_ALARMS) == 0);
+    CHECK(Gpio.get(ALARMB_PIN) == HIGH);
+
+    delay(HOLDOFF + 5);
+    uint32_t issued = batteryMonitor.getIssuedReads();
+    CHECK(!alarm.update());
+    CHECK(report.calls == 1 && alarm.getInterrupts() == 1);
+    CHECK(batteryMonitor.getIssuedReads() == issued);
+}
+
+/**
+ * RSOC stays below AlarmLowRSOC: the chip sets the bit again after it is cleared, ALARMB stays
+ * LOW without a new edge, and the alarm is read again only after the holdoff.
+ */
+static void persisting(LC709204FAlarm &alarm, report_t &report) {
+    gauge.setRegister(LC709204F_REG_RSOC, 5);
+    CHECK(alarm.getInterrupts() == 2);
+
+    CHECK(alarm.update());
+    CHECK(report.calls == 2);
+    CHECK(Gpio.get(ALARMB_PIN) == LOW);
+    CHECK(alarm.getInterrupts() == 2);
+
+    CHECK(!alarm.update());
+    CHECK(report.calls == 2);
+
+    delay(HOLDOFF + 5);
+    CHECK(alarm.update());
+    CHECK(report.calls == 3 && report.alarms == LC709204F_BATTERY_STATUS_LOW_RSOC);
+
+    // Back above the threshold, the bit set before is cleared at the next check
+    gauge.setRegister(LC709204F_REG_RSOC, 50);
+    CHECK(!alarm.update());
+    delay(HOLDOFF + 5);
+    CHECK(alarm.update());
+    CHECK(report.calls == 4);
+    CHECK(Gpio.get(ALARMB_PIN) == HIGH);
+    CHECK((gauge.getRegister(LC709204F_REG_BATTERY_STATUS) & LC709204F_BATTERY_STATUS_ALARMS) == 0);
+}
+
+/**
+ * A failed BatteryStatus read is retried at the next update(), the alarm is not lost.
+ */
+static void retry(LC709204FAlarm &alarm, report_t &report) {
+    int calls = report.calls;
+
+    gauge.setRegister(LC709204F_REG_RSOC, 8);
+    gauge.setRegister(LC709204F_REG_RSOC, 50);
+    gauge.injectNack(1);
+
+    CHECK(alarm.update());
+    CHECK(report.calls == calls);
+    CHECK(Gpio.get(ALARMB_PIN) == LOW);
+
+    CHECK(alarm.update());
+    CHECK(report.calls == calls + 1);
+    CHECK(Gpio.get(ALARMB_PIN) == HIGH);
+}
+
+/**
+ * After end() edges are no longer counted, and a second LC709204FAlarm can attach.
+ */
+static void detach(LC709204FAlarm &alarm) {
+    LC709204FAlarm other(batteryMonitor);
+    uint32_t interrupts = alarm.getInterrupts();
+
+    CHECK(!other.begin(ALARMB_PIN, onAlarm));
+    alarm.end();
+
+    gauge.setRegister(LC709204F_REG_RSOC, 8);
+    CHECK(alarm.getInterrupts() == interrupts);
+    CHECK(other.begin(ALARMB_PIN, onAlarm));
+    other.end();
+}
+
+int main(void) {
+    LC709204FAlarm alarm(batteryMonitor);
+    report_t report = {0, 0, 0};
+
+    Wire.attach(LC709204F_I2CADDR, &gauge);
+    gauge.setAlarmPin(ALARMB_PIN);
+    alarm.setHoldoff(HOLDOFF);
+
+    quiet(alarm, report);
+    single(alarm, report);
+    persisting(alarm, report);
+    retry(alarm, report);
+    detach(alarm);
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,176 @@
+/**
+ * @file batchtest.cpp
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Checks LC709204F::execute() batches against the host simulator
+ * @copyright MIT (see LICENSE.md)
+ *
+ * Build and run from the library folder:
+ *   g++ -O2 -DLC709204F_HOST_BUILD -I. extras/batchtest/batchtest.cpp *.cpp -o lc709204f_batchtest
+ *   ./lc709204f_batchtest
+ *
+ * The same checks run over i2c-dev, through a fake ioctl backed by the simulator:
+ *   g++ -O2 -DLC709204F_HOST_BUILD -DLC709204F_TRANSPORT_LINUX -I. extras/batchtest/batchtest.cpp *.cpp -o lc709204f_batchtest
+ *
+ * Prints one line per failed check, the exit code is 1 if any failed.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "LC709204F.h"
+#include "LC709204FBatch.h"
+#include "LC709204FSimulator.h"
+
+static LC709204FSimulator gauge;
+static int failures = 0;
+
+#if defined(LC709204F_TRANSPORT_LINUX)
+/**
+ * Fake adapter: passes the messages of an I2C_RDWR ioctl to the simulator, a STOP after the last one.
+ */
+static int fakeIoctl(int fd, unsigned long request, void *arg) {
+    struct i2c_rdwr_ioctl_data *data = (struct i2c_rdwr_ioctl_data *) arg;
+
+    (void) fd;
+    (void) request;
+
+    for (uint32_t i = 0; i < data->nmsgs; i++) {
+        struct i2c_msg &message = data->msgs[i];
+        bool stop = i + 1 == data->nmsgs;
+
+        if (message.flags & I2C_M_RD) {
+            size_t len = gauge.request(message.buf, message.len, stop);
+            memset(message.buf + len, 0xFF, message.len - len);
+        } else if (gauge.receive(message.buf, message.len, stop) != 0) {
+            errno = EREMOTEIO;
+            return -1;
+        }
+    }
+    return data->nmsgs;
+}
+
+static LC709204FLinuxI2C bus("/dev/null");
+static LC709204F batteryMonitor(&bus);
+#else
+static LC709204F batteryMonitor;
+#endif
+
+#define CHECK(condition)                                               \
+    do {                                                               \
+        if (!(condition)) {                                            \
+            printf("%s:%d: %s\n", __FILE__, __LINE__, #condition);     \
+            failures++;                                                \
+        }                                                              \
+    } while (0)
+
+/**
+ * Writes, reads back and restores a configuration register in one batch, with the shadow on:
+ * the read and the restoring write must see the first write.
+ */
+static void writeReadRestore(void) {
+    LC709204FBatch batch;
+    uint16_t old = gauge.getRegister(LC709204F_REG_APA);
+
+    batteryMonitor.enableShadow();
+    CHECK(batteryMonitor.refreshShadow());
+
+    batch.write(LC709204F_REG_APA, 0x0055);
+    int8_t readBack = batch.read(LC709204F_REG_APA);
+    batch.write(LC709204F_REG_APA, old);
+    int8_t again = batch.read(LC709204F_REG_APA);
+
+    CHECK(batch.execute(batteryMonitor));
+    CHECK(batch.getResult(readBack).value == 0x0055);
+    CHECK(batch.getResult(again).value == old);
+    CHECK(gauge.getRegister(LC709204F_REG_APA) == old);
+
+    // Nothing changes now: the same batch run again still reads 0x0055 in between
+    CHECK(batch.execute(batteryMonitor));
+    CHECK(batch.getResult(readBack).value == 0x0055);
+    CHECK(gauge.getRegister(LC709204F_REG_APA) == old);
+
+    batteryMonitor.enableShadow(false);
+}
+
+/**
+ * A write of the value the register holds is elided, unless an earlier item changed it.
+ */
+static void elision(void) {
+    LC709204FBatch batch;
+
+    batteryMonitor.enableShadow();
+    batteryMonitor.setWriteElision(true);
+    CHECK(batteryMonitor.refreshShadow());
+    gauge.setRegister(LC709204F_REG_ALARM_LOW_RSOC, 0);
+    CHECK(batteryMonitor.refreshShadow());
+
+    batch.write(LC709204F_REG_ALARM_LOW_RSOC, 10);
+    batch.write(LC709204F_REG_ALARM_LOW_RSOC, 0);
+    batch.write(LC709204F_REG_ALARM_LOW_RSOC, 0);
+
+    // Only the last write is redundant
+    uint32_t elided = batteryMonitor.getElidedWrites();
+    CHECK(batch.execute(batteryMonitor));
+    CHECK(batteryMonitor.getElidedWrites() - elided == 1);
+    CHECK(gauge.getRegister(LC709204F_REG_ALARM_LOW_RSOC) == 0);
+
+    batteryMonitor.setWriteElision(false);
+    batteryMonitor.enableShadow(false);
+}
+
+/**
+ * A NACK or a wrong CRC fails its own item only.
+ */
+static void isolatedFailures(void) {
+    LC709204FBatch batch;
+
+    int8_t voltage = batch.read(LC709204F_REG_CELL_VOLTAGE);
+    int8_t rsoc = batch.read(LC709204F_REG_RSOC);
+    int8_t alarm = batch.write(LC709204F_REG_ALARM_LOW_CELL_VOLTAGE, 3000);
+    int8_t ite = batch.read(LC709204F_REG_ITE);
+
+    gauge.injectCrcError(1);
+    CHECK(!batch.execute(batteryMonitor));
+    CHECK(batch.getResult(voltage).status == LC709204F_STATUS_CRC);
+    CHECK(batch.getResult(rsoc).status == LC709204F_STATUS_OK);
+    CHECK(batch.getResult(alarm).status == LC709204F_STATUS_OK);
+    CHECK(batch.getResult(ite).status == LC709204F_STATUS_OK);
+    CHECK(batteryMonitor.getLastStatus() == LC709204F_STATUS_CRC);
+
+    // Which item a NACK fails depends on the transport, see LC709204FTransport<LC709204FLinuxI2C>
+    gauge.injectNack(1);
+    CHECK(!batch.execute(batteryMonitor));
+
+    uint8_t nacked = 0;
+
+    for (uint8_t i = 0; i < batch.size(); i++) {
+        lc709204f_result_t result = batch.getResult(i);
+        const lc709204f_batch_item_t &item = batch.getItems()[i];
+
+        if (result.status == LC709204F_STATUS_NACK) {
+            nacked++;
+        } else {
+            CHECK(result.status == LC709204F_STATUS_OK);
+            CHECK(item.write || result.value == gauge.getRegister(item.command));
+        }
+    }
+    CHECK(nacked == 1);
+
+    CHECK(batch.execute(batteryMonitor));
+    CHECK(batch.getResult(voltage).value == gauge.getRegister(LC709204F_REG_CELL_VOLTAGE));
+}
+
+int main(void) {
+#if defined(LC709204F_TRANSPORT_LINUX)
+    bus.setIoctl(fakeIoctl);
+#else
+    Wire.attach(LC709204F_I2CADDR, &gauge);
+#endif
+
+    writeReadRestore();
+    elision();
+    isolatedFailures();
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
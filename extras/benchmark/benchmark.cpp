@@ -0,0 +1,243 @@
+/**
+ * @file benchmark.cpp
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Per-call bus cost and CPU cost of every LC709204F method, measured on the host simulator
+ * @copyright MIT (see LICENSE.md)
+ *
+ * Build and run from the library folder:
+ *   g++ -O2 -DLC709204F_HOST_BUILD -I. extras/benchmark/benchmark.cpp *.cpp -o lc709204f_benchmark
+ *   ./lc709204f_benchmark [iterations] > benchmark.csv
+ *
+ * Output is CSV, one line per method:
+ *   method,transactions,bytes,bus_us_100khz,bus_us_400khz,cpu_ns
+ * Bus figures are per call, cpu_ns is the host CPU time per call with the simulator included.
+ * Add -DLC709204F_CRC8_STRATEGY=... to compare the CRC8 strategies.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "LC709204F.h"
+#include "LC709204FSimulator.h"
+#include "LC709204FBatch.h"
+
+static LC709204FSimulator gauge;
+static LC709204F batteryMonitor;
+static lc709204f_battery_snapshot_t snapshot;
+static LC709204FBatch sweep;
+static volatile uint16_t rawTemperature = 0x0BA6;
+static volatile float floatSink;
+static volatile int16_t deciSink;
+static uint16_t rawTemperatures[64];
+static int16_t deciTemperatures[64];
+
+/**
+ * Exposes the CRC8 helpers of the driver.
+ */
+class CrcProbe : public LC709204F {
+public:
+    using LC709204F::LC709204F;
+    using LC709204F::crc8;
+    using LC709204F::decodeReply;
+    using LC709204F::encodeWrite;
+};
+
+static CrcProbe crcProbe;
+static CrcProbe crcProbeMoved(LC709204F_DEFAULT_BUS, 0x0C);
+static uint8_t reply[3];
+static uint8_t replyMoved[3];
+static uint8_t send[4];
+static uint16_t replyValue;
+static uint8_t frame[5] = {LC709204F_I2CADDR * 2, LC709204F_REG_CELL_VOLTAGE, LC709204F_I2CADDR * 2 | 0x1, 0x74, 0x0E};
+static volatile uint8_t crcSink;
+
+/**
+ * CRC8 of version 1.0.0, bit by bit.
+ */
+static uint8_t legacyCrc8(uint8_t *data, int len) {
+    const uint8_t POLYNOMIAL(0x07);
+    uint8_t crc(0x00);
+
+    for (int j = len; j; --j) {
+        crc ^= *data++;
+
+        for (int i = 8; i; --i) {
+            crc = (crc & 0x80) ? (crc << 1) ^ POLYNOMIAL : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+/**
+ * Register to °C conversion of version 1.0.0, through map() and float math.
+ */
+static float legacyCelsius(uint16_t temp) {
+    float temperature = map(temp, 0x980, 0xDCC, -300, 800);
+    return temperature / 10.0;
+}
+
+/**
+ * Process CPU time in nanoseconds.
+ */
+static uint64_t cpuNanos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * Runs one method `iterations` times and prints its cost.
+ */
+template<typename Call>
+static void bench(const char *name, unsigned long iterations, Call call) {
+    call();
+    Wire.resetStats();
+    uint64_t start = cpuNanos();
+
+    for (unsigned long i = 0; i < iterations; i++) {
+        call();
+    }
+
+    uint64_t elapsed = cpuNanos() - start;
+    lc709204f_bus_stats_t stats = Wire.getStats();
+
+    printf("\"%s\",%.2f,%.2f,%.1f,%.1f,%.1f\n", name,
+           (double) stats.transactions / iterations,
+           (double) stats.bytes / iterations,
+           (double) TwoWire::busTimeMicros(stats, 100000) / iterations,
+           (double) TwoWire::busTimeMicros(stats, 400000) / iterations,
+           (double) elapsed / iterations);
+}
+
+#define BENCH(call) bench(#call, iterations, [] { call; })
+
+int main(int argc, char **argv) {
+    unsigned long iterations = argc > 1 ? strtoul(argv[1], NULL, 10) : 100000;
+
+    if (iterations == 0)
+        iterations = 1;
+
+    Wire.attach(LC709204F_I2CADDR, &gauge);
+
+    printf("method,transactions,bytes,bus_us_100khz,bus_us_400khz,cpu_ns\n");
+
+    BENCH(batteryMonitor.init(LC709204F_APA_1000MAH, LC709204F_BATTERY_PROFILE_3_7_V));
+    BENCH(batteryMonitor.getTimeToEmpty());
+    BENCH(batteryMonitor.setBeforeRSOC(LC709204F_BEFORE_RSOC_FIRST_SAMPLING));
+    BENCH(batteryMonitor.getTimeToFull());
+    BENCH(batteryMonitor.getTSENSE1ThermistorB());
+    BENCH(batteryMonitor.setTSENSE1ThermistorB(3950));
+    BENCH(batteryMonitor.setInitialRSOC());
+    BENCH(batteryMonitor.getCellTemperatureTSENSE1());
+    BENCH(batteryMonitor.getCellTemperature());
+    BENCH(batteryMonitor.setCellTemperatureTSENSE1(0x0BA6));
+    BENCH(batteryMonitor.setCellTemperature(25.0));
+    BENCH(batteryMonitor.getCellTemperatureDeciC());
+    BENCH(batteryMonitor.setCellTemperatureDeciC(250));
+    BENCH(batteryMonitor.getCellVoltage());
+    BENCH(batteryMonitor.getCurrentDirection());
+    BENCH(batteryMonitor.setCurrentDirection(LC709204F_CURRENT_DIRECTION_AUTO_MODE));
+    BENCH(batteryMonitor.getAPA());
+    BENCH(batteryMonitor.setAPA(LC709204F_APA_1000MAH));
+    BENCH(batteryMonitor.getAPT());
+    BENCH(batteryMonitor.setAPT(0x001E));
+    BENCH(batteryMonitor.getRSOC());
+    BENCH(batteryMonitor.setRSOC(50));
+    BENCH(batteryMonitor.getTSENSE2ThermistorB());
+    BENCH(batteryMonitor.setTSENSE2ThermistorB(3380));
+    BENCH(batteryMonitor.getITE());
+    BENCH(batteryMonitor.getICVersion());
+    BENCH(batteryMonitor.getChangeOfTheParameter());
+    BENCH(batteryMonitor.setChangeOfTheParameter(LC709204F_BATTERY_PROFILE_3_7_V));
+    BENCH(batteryMonitor.getAlarmLowRSOC());
+    BENCH(batteryMonitor.setAlarmLowRSOC(10));
+    BENCH(batteryMonitor.getAlarmLowCellVoltage());
+    BENCH(batteryMonitor.setAlarmLowCellVoltage(3000));
+    BENCH(batteryMonitor.getICPowerMode());
+    BENCH(batteryMonitor.setICPowerMode(LC709204F_POWER_MODE_OPERATE));
+    BENCH(batteryMonitor.getStatusBit());
+    BENCH(batteryMonitor.setStatusBit(0x0003));
+    BENCH(batteryMonitor.setThermistors(true, true));
+    BENCH(batteryMonitor.getCycleCount());
+    BENCH(batteryMonitor.getBatteryStatus());
+    BENCH(batteryMonitor.setBatteryStatus(0x0040));
+    BENCH(batteryMonitor.getNumberOfTheParameter());
+    BENCH(batteryMonitor.getTerminationCurrentRate());
+    BENCH(batteryMonitor.setTerminationCurrentRate(0x0002));
+    BENCH(batteryMonitor.getEmptyCellVoltage());
+    BENCH(batteryMonitor.setEmptyCellVoltage(3000));
+    BENCH(batteryMonitor.getITEOffset());
+    BENCH(batteryMonitor.setITEOffset(0));
+    BENCH(batteryMonitor.getAlarmHighCellVoltage());
+    BENCH(batteryMonitor.setAlarmHighCellVoltage(4200));
+    BENCH(batteryMonitor.getAlarmLowTemperature());
+    BENCH(batteryMonitor.setAlarmLowTemperature(0.0));
+    BENCH(batteryMonitor.getAlarmHighTemperature());
+    BENCH(batteryMonitor.setAlarmHighTemperature(60.0));
+    BENCH(batteryMonitor.getAlarmLowTemperatureDeciC());
+    BENCH(batteryMonitor.setAlarmLowTemperatureDeciC(0));
+    BENCH(batteryMonitor.getAlarmHighTemperatureDeciC());
+    BENCH(batteryMonitor.setAlarmHighTemperatureDeciC(600));
+    BENCH(batteryMonitor.getTotalRunTime());
+    BENCH(batteryMonitor.setTotalRunTime(0));
+    BENCH(batteryMonitor.getAccumulatedTemperature());
+    BENCH(batteryMonitor.setAccumulatedTemperature(0));
+    BENCH(batteryMonitor.getAccumulatedRSOC());
+    BENCH(batteryMonitor.setAccumulatedRSOC(0));
+    BENCH(batteryMonitor.getMaximumCellVoltage());
+    BENCH(batteryMonitor.setMaximumCellVoltage(0));
+    BENCH(batteryMonitor.getMinimumCellVoltage());
+    BENCH(batteryMonitor.setMinimumCellVoltage(0x1388));
+    BENCH(batteryMonitor.getMaximumCellTemperatureTSENSE1());
+    BENCH(batteryMonitor.getMaximumCellTemperature());
+    BENCH(batteryMonitor.setMaximumCellTemperatureTSENSE1(0x0980));
+    BENCH(batteryMonitor.setMaximumCellTemperature(-30.0));
+    BENCH(batteryMonitor.getMinimumCellTemperatureTSENSE1());
+    BENCH(batteryMonitor.getMinimumCellTemperature());
+    BENCH(batteryMonitor.setMinimumCellTemperatureTSENSE1(0x0DCC));
+    BENCH(batteryMonitor.setMinimumCellTemperature(80.0));
+    BENCH(batteryMonitor.getAmbientTemperatureTSENSE2());
+    BENCH(batteryMonitor.getAmbientTemperature());
+    BENCH(batteryMonitor.getAmbientTemperatureDeciC());
+    BENCH(batteryMonitor.readTemperaturesDeciC(&deciTemperatures[0], &deciTemperatures[1]));
+    BENCH(batteryMonitor.getStateOfHealth());
+    BENCH(batteryMonitor.getUserId());
+    BENCH(batteryMonitor.readSnapshot(snapshot));
+
+    // Telemetry sweep with one read and one write, as one batch
+    sweep.read(LC709204F_REG_CELL_VOLTAGE);
+    sweep.read(LC709204F_REG_RSOC);
+    sweep.read(LC709204F_REG_ITE);
+    sweep.read(LC709204F_REG_TIME_TO_EMPTY);
+    sweep.read(LC709204F_REG_BATTERY_STATUS);
+    sweep.write(LC709204F_REG_CELL_TEMPERATURE_TSENSE1, 0x0BA6);
+    BENCH(sweep.execute(batteryMonitor));
+
+    // Temperature conversion alone, no bus traffic
+    BENCH(floatSink = legacyCelsius(rawTemperature));
+    BENCH(floatSink = LC709204F::toDeciCelsius(rawTemperature) / 10.0f);
+    BENCH(deciSink = LC709204F::toDeciCelsius(rawTemperature));
+    BENCH(LC709204F::toDeciCelsius(rawTemperatures, deciTemperatures, 64));
+
+    // CRC8 of the 5 bytes of a register read, no bus traffic. The data changes every call, so
+    // that the compiler cannot hoist the CRC out of the loop.
+    bench("legacyCrc8(frame, 5)", iterations, [] { frame[4]++; crcSink = legacyCrc8(frame, 5); });
+    bench("crc8(frame, 5)", iterations, [] { frame[4]++; crcSink = crcProbe.crc8(frame, 5); });
+
+    // CRC8 work of readWord()/writeWord() from the precomputed prefixes, to compare with the whole
+    // transfer hashed by legacyCrc8(). Each reply carries the CRC of its address.
+    uint8_t transfer[5] = {LC709204F_I2CADDR * 2, LC709204F_REG_CELL_VOLTAGE, LC709204F_I2CADDR * 2 | 0x1, 0x74, 0x0E};
+    uint8_t transferMoved[5] = {0x0C * 2, LC709204F_REG_CELL_VOLTAGE, 0x0C * 2 | 0x1, 0x74, 0x0E};
+
+    reply[0] = replyMoved[0] = 0x74;
+    reply[1] = replyMoved[1] = 0x0E;
+    reply[2] = legacyCrc8(transfer, 5);
+    replyMoved[2] = legacyCrc8(transferMoved, 5);
+    bench("decodeReply(reply)", iterations, [] { crcSink = crcProbe.decodeReply(LC709204F_REG_CELL_VOLTAGE, reply, &replyValue); });
+    bench("decodeReply(replyMoved), address 0x0C", iterations, [] { crcSink = crcProbeMoved.decodeReply(LC709204F_REG_CELL_VOLTAGE, replyMoved, &replyValue); });
+    bench("legacyCrc8(frame, 4)", iterations, [] { frame[3]++; crcSink = legacyCrc8(frame, 4); });
+    bench("encodeWrite(frame[4])", iterations, [] { frame[4]++; crcProbe.encodeWrite(LC709204F_REG_CELL_VOLTAGE, frame[4], send); });
+
+    return 0;
+}
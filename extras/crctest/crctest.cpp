@@ -0,0 +1,123 @@
+/**
+ * @file crctest.cpp
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Exhaustive check of the LC709204F CRC8 strategies and prefix tables against the bitwise CRC8 of version 1.0.0
+ * @copyright MIT (see LICENSE.md)
+ *
+ * Build and run from the library folder, once per strategy:
+ *   g++ -O2 -DLC709204F_HOST_BUILD -DLC709204F_CRC8_STRATEGY=LC709204F_CRC8_TABLE -I. extras/crctest/crctest.cpp *.cpp -o lc709204f_crctest
+ *   g++ -O2 -DLC709204F_HOST_BUILD -DLC709204F_CRC8_STRATEGY=LC709204F_CRC8_NIBBLE -I. extras/crctest/crctest.cpp *.cpp -o lc709204f_crctest
+ *   g++ -O2 -DLC709204F_HOST_BUILD -DLC709204F_CRC8_STRATEGY=LC709204F_CRC8_BITWISE -I. extras/crctest/crctest.cpp *.cpp -o lc709204f_crctest
+ *   ./lc709204f_crctest
+ *
+ * Prints one line per failed check, the exit code is 1 if any failed.
+ */
+
+#include <stdio.h>
+#include "LC709204F.h"
+
+static int failures = 0;
+
+#define CHECK(condition)                                               \
+    do {                                                               \
+        if (!(condition)) {                                            \
+            printf("%s:%d: %s\n", __FILE__, __LINE__, #condition);     \
+            failures++;                                                \
+        }                                                              \
+    } while (0)
+
+/**
+ * Exposes the CRC8 helpers of the driver.
+ */
+class CrcProbe : public LC709204F {
+public:
+    using LC709204F::crc8;
+    using LC709204F::decodeReply;
+    using LC709204F::encodeWrite;
+};
+
+/**
+ * CRC8 (polynomial 0x07) of version 1.0.0, bit by bit.
+ */
+static uint8_t legacyCrc8(const uint8_t *data, int len) {
+    const uint8_t POLYNOMIAL(0x07);
+    uint8_t crc(0x00);
+
+    for (int j = len; j; --j) {
+        crc ^= *data++;
+
+        for (int i = 8; i; --i) {
+            crc = (crc & 0x80) ? (crc << 1) ^ POLYNOMIAL : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+/**
+ * Every 1 and 2 byte input. The CRC8 of one byte is a permutation of the byte, so the second
+ * byte meets every CRC state with every data value: every step of longer inputs is covered too.
+ */
+static void allInputs(CrcProbe &probe) {
+    uint8_t data[2];
+
+    for (int a = 0; a < 256; a++) {
+        data[0] = a;
+        CHECK(probe.crc8(data, 1) == legacyCrc8(data, 1));
+
+        for (int b = 0; b < 256; b++) {
+            data[1] = b;
+            if (probe.crc8(data, 2) != legacyCrc8(data, 2)) {
+                printf("crc8 {0x%02X, 0x%02X}\n", a, b);
+                failures++;
+            }
+        }
+    }
+
+    CHECK(probe.crc8(data, 0) == 0x00);
+}
+
+/**
+ * Every 7-bit address and every command, with and without a prefix table entry: the CRC of
+ * encodeWrite() and the one decodeReply() expects are those of the whole transfer.
+ */
+static void allAddresses(CrcProbe &probe) {
+    for (int address = 0; address < 128; address++) {
+        probe.setAddress(address);
+
+        for (int command = 0; command < 256; command++) {
+            uint16_t data = (command * 0x0101) ^ (address << 4);
+            uint8_t frame[5] = {(uint8_t)(address * 2), (uint8_t) command, (uint8_t)(address * 2 | 0x1), (uint8_t)(data & 0xFF), (uint8_t)(data >> 8)};
+            uint8_t written[4] = {frame[0], frame[1], frame[3], frame[4]};
+            uint8_t send[4];
+            uint8_t reply[3] = {frame[3], frame[4], legacyCrc8(frame, 5)};
+            uint16_t value = 0;
+            bool ok = true;
+
+            probe.encodeWrite(command, data, send);
+            ok = ok && send[0] == command && send[1] == frame[3] && send[2] == frame[4];
+            ok = ok && send[3] == legacyCrc8(written, 4);
+
+            ok = ok && probe.decodeReply(command, reply, &value) && value == data;
+            reply[2] ^= 0x01;
+            ok = ok && !probe.decodeReply(command, reply, &value);
+
+            if (!ok) {
+                printf("address 0x%02X command 0x%02X\n", address, command);
+                failures++;
+            }
+        }
+    }
+
+    probe.setAddress(LC709204F_I2CADDR);
+}
+
+int main(void) {
+    CrcProbe probe;
+
+    allInputs(probe);
+    allAddresses(probe);
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,187 @@
+/**
+ * @file dutycycletest.cpp
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Checks LC709204FDutyCycle against the host simulator
+ * @copyright MIT (see LICENSE.md)
+ *
+ * Build and run from the library folder:
+ *   g++ -O2 -DLC709204F_HOST_BUILD -I. extras/dutycycletest/dutycycletest.cpp *.cpp -o lc709204f_dutycycletest
+ *   ./lc709204f_dutycycletest
+ *
+ * Runs on millis() with periods of tens of ms, under a second in all. Prints one line per failed
+ * check, the exit code is 1 if any failed.
+ */
+
+#include <stdio.h>
+#include "LC709204F.h"
+#include "LC709204FDutyCycle.h"
+#include "LC709204FSimulator.h"
+
+#define PERIOD 60        /// Acquisition period, ms
+#define SETTLE 25        /// Settle time of the duty cycle, ms
+#define GAUGE_SETTLE 15  /// Time the simulator takes to measure after a wake up, ms
+#define TOLERANCE 5      /// Scheduling slack allowed on host timings, ms
+
+static LC709204FSimulator gauge;
+static LC709204F batteryMonitor;
+static int failures = 0;
+
+#define CHECK(condition)                                               \
+    do {                                                               \
+        if (!(condition)) {                                            \
+            printf("%s:%d: %s\n", __FILE__, __LINE__, #condition);     \
+            failures++;                                                \
+        }                                                              \
+    } while (0)
+
+/**
+ * Calls run() until an acquisition completes, sleeping getIdleTime() in between.
+ *
+ * @return False if none completed within two periods
+ */
+static bool runOnce(LC709204FDutyCycle &dutyCycle) {
+    unsigned long start = millis();
+
+    while (!dutyCycle.run()) {
+        if (millis() - start > 2 * PERIOD)
+            return false;
+        delay(dutyCycle.getIdleTime());
+    }
+    return true;
+}
+
+/**
+ * Asleep between acquisitions, woken up once per period, read only after the settle time, so
+ * the measurements set while asleep are the ones read.
+ */
+static void cycle(void) {
+    LC709204FDutyCycle dutyCycle(batteryMonitor, PERIOD, SETTLE, LC709204F_FIELD_CELL_VOLTAGE | LC709204F_FIELD_RSOC);
+
+    gauge.setRegister(LC709204F_REG_IC_POWER_MODE, LC709204F_POWER_MODE_OPERATE);
+    CHECK(dutyCycle.begin());
+    CHECK(dutyCycle.getState() == LC709204F_DUTY_SLEEPING);
+    CHECK(gauge.getRegister(LC709204F_REG_IC_POWER_MODE) == LC709204F_POWER_MODE_SLEEP);
+
+    gauge.setMeasurement(LC709204F_REG_CELL_VOLTAGE, 3810);
+    gauge.setMeasurement(LC709204F_REG_RSOC, 61);
+
+    // Due at once: the first run() wakes the gauge up and reads nothing yet
+    uint32_t issued = batteryMonitor.getIssuedReads();
+    CHECK(!dutyCycle.run());
+    CHECK(dutyCycle.getState() == LC709204F_DUTY_SETTLING);
+    CHECK(gauge.getRegister(LC709204F_REG_IC_POWER_MODE) == LC709204F_POWER_MODE_OPERATE);
+    CHECK(dutyCycle.getIdleTime() > SETTLE - TOLERANCE);
+    CHECK(!dutyCycle.run());
+    CHECK(batteryMonitor.getIssuedReads() == issued);
+
+    CHECK(runOnce(dutyCycle));
+    CHECK(dutyCycle.getState() == LC709204F_DUTY_SLEEPING);
+    CHECK(gauge.getRegister(LC709204F_REG_IC_POWER_MODE) == LC709204F_POWER_MODE_SLEEP);
+    CHECK(dutyCycle.getSnapshot().cellVoltage == 3810 && dutyCycle.getSnapshot().rsoc == 61);
+    CHECK(dutyCycle.getSnapshot().valid == (LC709204F_FIELD_CELL_VOLTAGE | LC709204F_FIELD_RSOC));
+
+    lc709204f_duty_stats_t stats = dutyCycle.getStats();
+    CHECK(stats.cycles == 1 && stats.failures == 0);
+    CHECK(stats.lastLatency >= SETTLE && stats.lastLatency < SETTLE + TOLERANCE);
+
+    // Nothing to do until the next period
+    CHECK(dutyCycle.getIdleTime() > PERIOD - SETTLE - TOLERANCE);
+    CHECK(!dutyCycle.run());
+
+    gauge.setMeasurement(LC709204F_REG_CELL_VOLTAGE, 3790);
+    CHECK(runOnce(dutyCycle));
+    CHECK(dutyCycle.getSnapshot().cellVoltage == 3790);
+    CHECK(dutyCycle.getStats().cycles == 2);
+
+    // The blocking acquisition wakes up now and waits for the settle time
+    unsigned long start = millis();
+    CHECK(dutyCycle.acquire());
+    CHECK(millis() - start >= SETTLE);
+    CHECK(dutyCycle.getState() == LC709204F_DUTY_SLEEPING);
+}
+
+/**
+ * A failed sleep write in begin() leaves the duty cycle asleep: the first run() writes the
+ * wake up and waits for the settle time, it does not read right away.
+ */
+static void beginFailure(void) {
+    LC709204FDutyCycle dutyCycle(batteryMonitor, PERIOD, SETTLE, LC709204F_FIELD_CELL_VOLTAGE);
+
+    gauge.setRegister(LC709204F_REG_IC_POWER_MODE, LC709204F_POWER_MODE_OPERATE);
+    batteryMonitor.invalidateShadow();
+    gauge.injectNack(1);
+
+    CHECK(!dutyCycle.begin());
+    CHECK(dutyCycle.getState() == LC709204F_DUTY_SLEEPING);
+
+    uint32_t reads = batteryMonitor.getIssuedReads();
+    uint32_t writes = batteryMonitor.getIssuedWrites();
+    CHECK(!dutyCycle.run());
+    CHECK(dutyCycle.getState() == LC709204F_DUTY_SETTLING);
+    CHECK(batteryMonitor.getIssuedReads() == reads);
+    CHECK(batteryMonitor.getIssuedWrites() - writes == 1);
+    CHECK(dutyCycle.getIdleTime() > SETTLE - TOLERANCE);
+
+    CHECK(runOnce(dutyCycle));
+    CHECK(dutyCycle.getStats().lastLatency >= SETTLE);
+    CHECK(gauge.getRegister(LC709204F_REG_IC_POWER_MODE) == LC709204F_POWER_MODE_SLEEP);
+
+    // A failed wake up is counted, the duty cycle stays asleep
+    gauge.injectNack(1);
+    delay(dutyCycle.getIdleTime());
+    CHECK(!dutyCycle.run());
+    CHECK(dutyCycle.getState() == LC709204F_DUTY_SLEEPING);
+    CHECK(dutyCycle.getStats().failures == 1);
+}
+
+/**
+ * The bus time is that of the transfers on the bus, the mode times add up to the time elapsed
+ * and match the simulator, and the charge follows from the times and currents.
+ */
+static void accounting(void) {
+    static const uint32_t FREQUENCY = 400000;
+    LC709204FDutyCycle dutyCycle(batteryMonitor, PERIOD, SETTLE);
+
+    gauge.setRegister(LC709204F_REG_IC_POWER_MODE, LC709204F_POWER_MODE_OPERATE);
+    batteryMonitor.invalidateShadow();
+    dutyCycle.setBus(FREQUENCY);
+    dutyCycle.setCurrents(3000, 500);
+
+    unsigned long start = millis();
+    unsigned long operateStart = gauge.getOperateTime();
+
+    Wire.resetStats();
+    dutyCycle.resetStats();
+    CHECK(dutyCycle.begin());
+
+    for (int i = 0; i < 3; i++) {
+        CHECK(runOnce(dutyCycle));
+    }
+
+    lc709204f_duty_stats_t stats = dutyCycle.getStats();
+    unsigned long elapsed = millis() - start;
+    unsigned long operated = gauge.getOperateTime() - operateStart;
+
+    CHECK(stats.cycles == 3 && stats.failures == 0);
+    CHECK(stats.busTime == TwoWire::busTimeMicros(Wire.getStats(), FREQUENCY));
+    CHECK(stats.busTime > 0);
+
+    CHECK(stats.operateTime + stats.sleepTime <= elapsed);
+    CHECK(stats.operateTime + stats.sleepTime + TOLERANCE >= elapsed);
+    CHECK(stats.operateTime >= 3 * SETTLE);
+    CHECK(stats.operateTime <= operated + TOLERANCE && operated <= stats.operateTime + TOLERANCE);
+    CHECK(stats.charge == (uint32_t)(((uint64_t) stats.operateTime * 3000 + (uint64_t) stats.sleepTime * 500) / 1000));
+}
+
+int main(void) {
+    Wire.attach(LC709204F_I2CADDR, &gauge);
+    gauge.setSettleTime(GAUGE_SETTLE);
+
+    cycle();
+    beginFailure();
+    accounting();
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,127 @@
+/**
+ * @file i2cdev.cpp
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Reads a LC709204F from Linux through i2c-dev, or from a simulated one behind a fake ioctl
+ * @copyright MIT (see LICENSE.md)
+ *
+ * Build from the library folder:
+ *   g++ -O2 -DLC709204F_HOST_BUILD -DLC709204F_TRANSPORT_LINUX -I. extras/i2cdev/i2cdev.cpp *.cpp -o lc709204f_i2cdev
+ *
+ * Usage:
+ *   ./lc709204f_i2cdev [-d /dev/i2c-1] [-n count] [-i ms]   read snapshots, CSV to stdout
+ *   ./lc709204f_i2cdev -f [-n count] [-i ms]                same against a simulated gauge, no hardware needed
+ *
+ * The ioctls issued per snapshot and per register read are printed to stderr, the exit code is 1
+ * if a snapshot could not be read completely.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "LC709204F.h"
+#include "LC709204FSimulator.h"
+
+static LC709204FSimulator simulator;
+
+/**
+ * Fake adapter: passes the messages of an I2C_RDWR ioctl to the simulator, a STOP after the last one.
+ */
+static int fakeIoctl(int fd, unsigned long request, void *arg) {
+    struct i2c_rdwr_ioctl_data *data = (struct i2c_rdwr_ioctl_data *) arg;
+
+    (void) fd;
+
+    if (request != I2C_RDWR || data->nmsgs > LC709204F_LINUX_MAX_MESSAGES) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < data->nmsgs; i++) {
+        struct i2c_msg &message = data->msgs[i];
+        bool stop = i + 1 == data->nmsgs;
+
+        if (message.addr != LC709204F_I2CADDR) {
+            errno = ENXIO;
+            return -1;
+        }
+
+        if (message.flags & I2C_M_RD) {
+            // A real adapter clocks in every byte, whatever the device sends
+            size_t len = simulator.request(message.buf, message.len, stop);
+            memset(message.buf + len, 0xFF, message.len - len);
+        } else if (simulator.receive(message.buf, message.len, stop) != 0) {
+            errno = EREMOTEIO;
+            return -1;
+        }
+    }
+    return data->nmsgs;
+}
+
+int main(int argc, char **argv) {
+    const char *device = LC709204F_LINUX_DEVICE;
+    bool fake = false;
+    unsigned long count = 1;
+    unsigned long interval = 1000;
+
+    for (int arg = 1; arg < argc; arg++) {
+        if (strcmp(argv[arg], "-f") == 0) {
+            fake = true;
+        } else if (strcmp(argv[arg], "-d") == 0 && arg + 1 < argc) {
+            device = argv[++arg];
+        } else if (strcmp(argv[arg], "-n") == 0 && arg + 1 < argc) {
+            count = strtoul(argv[++arg], NULL, 10);
+        } else if (strcmp(argv[arg], "-i") == 0 && arg + 1 < argc) {
+            interval = strtoul(argv[++arg], NULL, 10);
+        } else {
+            fprintf(stderr, "usage: %s [-d device | -f] [-n count] [-i ms]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    LC709204FLinuxI2C bus(device);
+    LC709204F batteryMonitor(&bus);
+
+    if (fake) {
+        bus.setIoctl(fakeIoctl);
+    } else if (!bus.begin()) {
+        perror(device);
+        return 2;
+    }
+
+    uint32_t ioctls = bus.getIoctls();
+    uint16_t version = batteryMonitor.getICVersion();
+    fprintf(stderr, "IC version 0x%04X, %u ioctl per register read\n", version, bus.getIoctls() - ioctls);
+
+    if (batteryMonitor.getLastStatus() != LC709204F_STATUS_OK) {
+        fprintf(stderr, "no LC709204F at 0x%02X on %s\n", LC709204F_I2CADDR, fake ? "fake adapter" : device);
+        return 1;
+    }
+
+    puts("timestamp,cellVoltage,rsoc,ite,timeToEmpty,timeToFull,cellTemperature,ambientTemperature,batteryStatus,cycleCount,stateOfHealth");
+
+    // Registers a snapshot reads, one per field requested
+    const uint16_t fields = LC709204F_FIELD_ALL;
+    const int registers = __builtin_popcount(fields);
+    int result = 0;
+
+    for (unsigned long i = 0; i < count; i++) {
+        lc709204f_battery_snapshot_t s;
+
+        if (i)
+            delay(interval);
+
+        ioctls = bus.getIoctls();
+
+        if (!batteryMonitor.readSnapshot(s, fields)) {
+            fprintf(stderr, "snapshot incomplete, valid 0x%03X, status %d\n", s.valid, batteryMonitor.getLastStatus());
+            result = 1;
+        }
+
+        printf("%lu,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u\n", millis(), s.cellVoltage, s.rsoc, s.ite, s.timeToEmpty, s.timeToFull,
+               s.cellTemperature, s.ambientTemperature, s.batteryStatus, s.cycleCount, s.stateOfHealth);
+        fprintf(stderr, "%u ioctl for %d registers\n", bus.getIoctls() - ioctls, registers);
+    }
+
+    return result;
+}
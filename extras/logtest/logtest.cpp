@@ -0,0 +1,246 @@
+/**
+ * @file logtest.cpp
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Round trip checks of LC709204FLogEncoder and LC709204FLogDecoder
+ * @copyright MIT (see LICENSE.md)
+ *
+ * Build and run from the library folder:
+ *   g++ -O2 -DLC709204F_HOST_BUILD -I. extras/logtest/logtest.cpp *.cpp -o lc709204f_logtest
+ *   ./lc709204f_logtest
+ *
+ * Prints one line per failed check, the exit code is 1 if any failed.
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "LC709204FLog.h"
+
+#define RECORDS 200 /// Records per round trip
+
+static int failures = 0;
+
+#define CHECK(condition)                                               \
+    do {                                                               \
+        if (!(condition)) {                                            \
+            printf("%s:%d: %s\n", __FILE__, __LINE__, #condition);     \
+            failures++;                                                \
+        }                                                              \
+    } while (0)
+
+/**
+ * Offsets of the snapshot fields, in lc709204f_snapshot_field_t bit order.
+ */
+static const uint8_t SNAPSHOT_OFFSETS[LC709204F_LOG_FIELDS] = {
+    offsetof(lc709204f_battery_snapshot_t, cellVoltage),
+    offsetof(lc709204f_battery_snapshot_t, rsoc),
+    offsetof(lc709204f_battery_snapshot_t, ite),
+    offsetof(lc709204f_battery_snapshot_t, timeToEmpty),
+    offsetof(lc709204f_battery_snapshot_t, timeToFull),
+    offsetof(lc709204f_battery_snapshot_t, cellTemperature),
+    offsetof(lc709204f_battery_snapshot_t, ambientTemperature),
+    offsetof(lc709204f_battery_snapshot_t, batteryStatus),
+    offsetof(lc709204f_battery_snapshot_t, cycleCount),
+    offsetof(lc709204f_battery_snapshot_t, stateOfHealth),
+};
+
+static uint16_t *snapshotField(lc709204f_battery_snapshot_t &snapshot, uint8_t field) {
+    return (uint16_t *)((uint8_t *) &snapshot + SNAPSHOT_OFFSETS[field]);
+}
+
+static uint16_t snapshotField(const lc709204f_battery_snapshot_t &snapshot, uint8_t field) {
+    return *(const uint16_t *)((const uint8_t *) &snapshot + SNAPSHOT_OFFSETS[field]);
+}
+
+/**
+ * Log of RECORDS records, with what each of them must decode to.
+ */
+typedef struct {
+    uint8_t data[RECORDS * LC709204F_LOG_MAX_RECORD];
+    size_t offsets[RECORDS + 1];
+    lc709204f_battery_snapshot_t expected[RECORDS];
+    uint32_t timestamps[RECORDS];
+} log_t;
+
+static log_t testLog;
+
+/**
+ * Encodes a log: values move by small and large steps, some records miss fields, the timestamps
+ * start at `start` and advance by about a second.
+ */
+static void encodeLog(uint32_t start, uint16_t keyframeInterval) {
+    LC709204FLogEncoder encoder(LC709204F_FIELD_ALL, keyframeInterval);
+    lc709204f_battery_snapshot_t snapshot;
+    lc709204f_battery_snapshot_t known;
+    size_t pos = 0;
+
+    memset(&known, 0, sizeof(known));
+
+    for (int i = 0; i < RECORDS; i++) {
+        for (uint8_t f = 0; f < LC709204F_LOG_FIELDS; f++) {
+            // Small steps, with a jump every 17 records to get long varints and wrapping differences
+            *snapshotField(snapshot, f) = (uint16_t)(3700 + f * 1000 - i * (f + 1) + (i % 17 == 0 ? 0x8000 : 0));
+        }
+
+        // Every 5th record misses a field, every 23rd carries a single one
+        snapshot.valid = LC709204F_FIELD_ALL;
+        if (i % 5 == 4)
+            snapshot.valid &= ~(1 << (i % LC709204F_LOG_FIELDS));
+        if (i % 23 == 22)
+            snapshot.valid = LC709204F_FIELD_RSOC;
+
+        uint32_t timestamp = start + i * 1000 + i % 3;
+        size_t len = encoder.encode(snapshot, timestamp, testLog.data + pos, LC709204F_LOG_MAX_RECORD);
+
+        CHECK(len > 0 && len <= LC709204F_LOG_MAX_RECORD);
+
+        for (uint8_t f = 0; f < LC709204F_LOG_FIELDS; f++) {
+            if (snapshot.valid & (1 << f))
+                *snapshotField(known, f) = snapshotField((const lc709204f_battery_snapshot_t &) snapshot, f);
+        }
+        known.valid = snapshot.valid;
+
+        testLog.offsets[i] = pos;
+        testLog.expected[i] = known;
+        testLog.timestamps[i] = timestamp;
+        pos += len;
+    }
+    testLog.offsets[RECORDS] = pos;
+}
+
+static bool sameSnapshot(const lc709204f_battery_snapshot_t &a, const lc709204f_battery_snapshot_t &b) {
+    for (uint8_t f = 0; f < LC709204F_LOG_FIELDS; f++) {
+        if (snapshotField(a, f) != snapshotField(b, f))
+            return false;
+    }
+    return a.valid == b.valid;
+}
+
+/**
+ * Decodes the whole log in one buffer: every record comes back with its timestamp, its mask, and
+ * the missing fields at their last logged value.
+ */
+static void decodeLog(void) {
+    LC709204FLogDecoder decoder;
+    lc709204f_battery_snapshot_t snapshot;
+    uint32_t timestamp;
+    size_t pos = 0;
+
+    for (int i = 0; i < RECORDS; i++) {
+        size_t used = decoder.decode(testLog.data + pos, testLog.offsets[RECORDS] - pos, snapshot, timestamp);
+
+        if (used != testLog.offsets[i + 1] - testLog.offsets[i] || timestamp != testLog.timestamps[i] || !sameSnapshot(snapshot, testLog.expected[i])) {
+            printf("record %d: used %zu, timestamp 0x%08X instead of 0x%08X\n", i, used, timestamp, testLog.timestamps[i]);
+            failures++;
+            return;
+        }
+        pos += used;
+    }
+
+    CHECK(decoder.decode(testLog.data + pos, 0, snapshot, timestamp) == 0);
+}
+
+/**
+ * Keyframes and deltas, with the default interval and a keyframe on every record.
+ */
+static void roundTrip(void) {
+    encodeLog(12345, LC709204F_LOG_KEYFRAME_INTERVAL);
+    decodeLog();
+
+    encodeLog(12345, 1);
+    decodeLog();
+}
+
+/**
+ * Timestamps across the 32-bit wrap of millis(), in keyframes and in deltas.
+ */
+static void wrap(void) {
+    int deltas = 0;
+
+    // The wrap moves by one record each time, so that it lands in keyframes and in deltas
+    for (int k = 0; k < 8; k++) {
+        encodeLog(0xFFFFFFFF - (RECORDS / 2 + k) * 1000 + 500, 8);
+
+        for (int i = 1; i < RECORDS; i++) {
+            if (testLog.timestamps[i] < testLog.timestamps[i - 1] && !(testLog.data[testLog.offsets[i]] & 1))
+                deltas++;
+        }
+        decodeLog();
+    }
+    CHECK(deltas > 0);
+}
+
+/**
+ * Every record cut short needs more data and leaves the decoder as it was; a delta record
+ * before any keyframe and an unknown field are corrupt.
+ */
+static void truncation(void) {
+    LC709204FLogDecoder decoder;
+    lc709204f_battery_snapshot_t snapshot;
+    uint32_t timestamp = 0;
+
+    encodeLog(1000, 8);
+
+    for (int i = 0; i < RECORDS; i++) {
+        const uint8_t *record = testLog.data + testLog.offsets[i];
+        size_t len = testLog.offsets[i + 1] - testLog.offsets[i];
+
+        for (size_t cut = 0; cut < len; cut++) {
+            if (decoder.decode(record, cut, snapshot, timestamp) != 0) {
+                printf("record %d: decoded from %zu of %zu bytes\n", i, cut, len);
+                failures++;
+            }
+        }
+
+        CHECK(decoder.decode(record, len, snapshot, timestamp) == len);
+        CHECK(timestamp == testLog.timestamps[i]);
+        CHECK(sameSnapshot(snapshot, testLog.expected[i]));
+    }
+
+    // Record 1 is a delta: a decoder that missed the keyframe does not start there
+    LC709204FLogDecoder late;
+    CHECK(late.decode(testLog.data + testLog.offsets[1], testLog.offsets[2] - testLog.offsets[1], snapshot, timestamp) == LC709204F_LOG_INVALID);
+
+    uint8_t unknown[] = {(uint8_t)(0x80 | 0x01), 0x10, 0x00}; // keyframe of field bit 10, past LC709204F_FIELD_ALL
+    CHECK(late.decode(unknown, sizeof(unknown), snapshot, timestamp) == LC709204F_LOG_INVALID);
+}
+
+/**
+ * A record that does not fit is not written and the next one is a keyframe, so the log stays
+ * decodable.
+ */
+static void fullBuffer(void) {
+    LC709204FLogEncoder encoder;
+    LC709204FLogDecoder decoder;
+    lc709204f_battery_snapshot_t snapshot;
+    lc709204f_battery_snapshot_t decoded;
+    uint8_t record[LC709204F_LOG_MAX_RECORD];
+    uint32_t timestamp;
+
+    memset(&snapshot, 0, sizeof(snapshot));
+    snapshot.cellVoltage = 3700;
+    snapshot.valid = LC709204F_FIELD_CELL_VOLTAGE;
+
+    size_t len = encoder.encode(snapshot, 1000, record, sizeof(record));
+    CHECK(decoder.decode(record, len, decoded, timestamp) == len);
+
+    snapshot.cellVoltage = 3690;
+    CHECK(encoder.encode(snapshot, 2000, record, 1) == 0);
+
+    snapshot.cellVoltage = 3680;
+    len = encoder.encode(snapshot, 3000, record, sizeof(record));
+    CHECK(len > 0 && (record[0] & 1));
+    CHECK(decoder.decode(record, len, decoded, timestamp) == len);
+    CHECK(decoded.cellVoltage == 3680 && timestamp == 3000);
+}
+
+int main(void) {
+    roundTrip();
+    wrap();
+    truncation();
+    fullBuffer();
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,202 @@
+/**
+ * @file logtool.cpp
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Decodes and validates LC709204FLogEncoder logs on the host
+ * @copyright MIT (see LICENSE.md)
+ *
+ * Build from the library folder:
+ *   g++ -O2 -DLC709204F_HOST_BUILD -I. extras/logtool/logtool.cpp *.cpp -o lc709204f_logtool
+ *
+ * Usage:
+ *   ./lc709204f_logtool log.bin > log.csv     convert to CSV, one line per record
+ *   ./lc709204f_logtool -c log.bin            validate only
+ *   ./lc709204f_logtool -g records > log.bin  generate a synthetic log, eg: for throughput tests
+ *
+ * Use - as file name for stdin. Statistics are printed to stderr, the exit code is 1 if the log
+ * is corrupt or truncated.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "LC709204FLog.h"
+
+#define CHUNK_SIZE 65536
+
+/**
+ * Monotonic time in seconds.
+ */
+static double seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Appends an unsigned value in decimal followed by a separator.
+ */
+static char *putDecimal(char *p, unsigned long value, char separator) {
+    char digits[20];
+    int n = 0;
+
+    do {
+        digits[n++] = '0' + value % 10;
+        value /= 10;
+    } while (value);
+
+    while (n) {
+        *p++ = digits[--n];
+    }
+    *p++ = separator;
+    return p;
+}
+
+/**
+ * Writes a CSV line, fields missing from the record are left empty.
+ */
+static void printRecord(FILE *out, unsigned long timestamp, const lc709204f_battery_snapshot_t &s) {
+    const uint16_t values[LC709204F_LOG_FIELDS] = {
+        s.cellVoltage, s.rsoc, s.ite, s.timeToEmpty, s.timeToFull,
+        s.cellTemperature, s.ambientTemperature, s.batteryStatus, s.cycleCount, s.stateOfHealth,
+    };
+    char line[128];
+    char *p = putDecimal(line, timestamp, ',');
+
+    for (uint8_t i = 0; i < LC709204F_LOG_FIELDS; i++) {
+        char separator = i + 1 < LC709204F_LOG_FIELDS ? ',' : '\n';
+
+        if (s.valid & (1 << i)) {
+            p = putDecimal(p, values[i], separator);
+        } else {
+            *p++ = separator;
+        }
+    }
+    fwrite(line, 1, p - line, out);
+}
+
+/**
+ * Decodes a whole log, chunk by chunk.
+ */
+static int decode(FILE *in, FILE *out, bool csv) {
+    static uint8_t buffer[CHUNK_SIZE + LC709204F_LOG_MAX_RECORD];
+    LC709204FLogDecoder decoder;
+    lc709204f_battery_snapshot_t snapshot;
+    uint32_t timestamp;
+    unsigned long records = 0;
+    unsigned long long offset = 0;
+    size_t len = 0;
+    size_t pos = 0;
+    double start = seconds();
+
+    if (csv)
+        fputs("timestamp,cellVoltage,rsoc,ite,timeToEmpty,timeToFull,cellTemperature,ambientTemperature,batteryStatus,cycleCount,stateOfHealth\n", out);
+
+    for (;;) {
+        // Keep the incomplete tail of the previous chunk
+        memmove(buffer, buffer + pos, len - pos);
+        len -= pos;
+        offset += pos;
+        pos = 0;
+
+        size_t read = fread(buffer + len, 1, CHUNK_SIZE, in);
+        len += read;
+
+        while (pos < len) {
+            size_t used = decoder.decode(buffer + pos, len - pos, snapshot, timestamp);
+
+            if (used == LC709204F_LOG_INVALID) {
+                fprintf(stderr, "corrupt record at offset %llu, after %lu records\n", offset + pos, records);
+                return 1;
+            }
+
+            if (used == 0)
+                break;
+
+            if (csv)
+                printRecord(out, timestamp, snapshot);
+
+            records++;
+            pos += used;
+        }
+
+        if (read == 0)
+            break;
+    }
+
+    double elapsed = seconds() - start;
+    offset += pos;
+
+    fprintf(stderr, "%lu records, %llu bytes, %.2f bytes/record, %.1f MB/s\n", records, offset,
+            records ? (double) offset / records : 0.0, elapsed > 0 ? offset / elapsed / 1e6 : 0.0);
+
+    if (pos != len) {
+        fprintf(stderr, "truncated record at offset %llu\n", offset);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * Writes a synthetic log of a slowly discharging battery sampled every second.
+ */
+static int generate(FILE *out, unsigned long records) {
+    LC709204FLogEncoder encoder;
+    lc709204f_battery_snapshot_t s;
+    uint8_t record[LC709204F_LOG_MAX_RECORD];
+
+    srand(1);
+    s.cycleCount = 12;
+    s.stateOfHealth = 98;
+    s.batteryStatus = 0x0040;
+
+    for (unsigned long i = 0; i < records; i++) {
+        s.ite = 1000 - (uint16_t)(i / 40 % 1000);
+        s.rsoc = s.ite / 10;
+        s.cellVoltage = 3300 + s.ite + rand() % 5;
+        s.timeToEmpty = s.ite * 2;
+        s.timeToFull = 0xFFFF;
+        s.cellTemperature = 2982 + rand() % 3;
+        s.ambientTemperature = 2962 + rand() % 2;
+        s.valid = LC709204F_FIELD_ALL;
+
+        size_t len = encoder.encode(s, 1000 * i + rand() % 3, record, sizeof(record));
+        fwrite(record, 1, len, out);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    static char outputBuffer[CHUNK_SIZE];
+    bool csv = true;
+    int arg = 1;
+
+    setvbuf(stdout, outputBuffer, _IOFBF, sizeof(outputBuffer));
+
+    if (arg < argc && strcmp(argv[arg], "-g") == 0)
+        return generate(stdout, arg + 1 < argc ? strtoul(argv[arg + 1], NULL, 10) : 100000);
+
+    if (arg < argc && strcmp(argv[arg], "-c") == 0) {
+        csv = false;
+        arg++;
+    }
+
+    if (arg >= argc) {
+        fprintf(stderr, "usage: %s [-c] log.bin | -g records\n", argv[0]);
+        return 2;
+    }
+
+    FILE *in = strcmp(argv[arg], "-") == 0 ? stdin : fopen(argv[arg], "rb");
+    if (in == NULL) {
+        perror(argv[arg]);
+        return 2;
+    }
+
+    int result = decode(in, stdout, csv);
+
+    if (in != stdin)
+        fclose(in);
+
+    return result;
+}
@@ -0,0 +1,186 @@
+/**
+ * @file ringtest.cpp
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Producer / consumer test of LC709204FRing and LC709204FSampler on two threads
+ * @copyright MIT (see LICENSE.md)
+ *
+ * Build and run from the library folder:
+ *   g++ -O2 -pthread -DLC709204F_HOST_BUILD -I. extras/ringtest/ringtest.cpp *.cpp -o lc709204f_ringtest
+ *   ./lc709204f_ringtest [iterations]
+ *
+ * Add -fsanitize=thread to look for data races as well. Prints one line per failed check, the
+ * exit code is 1 if any failed.
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <thread>
+#include "LC709204F.h"
+#include "LC709204FRing.h"
+#include "LC709204FSimulator.h"
+
+#define CAPACITY 4 /// Small, so that both the full and the empty ring are hit often
+
+static LC709204FSimulator gauge;
+static LC709204F batteryMonitor;
+static std::atomic<int> failures(0);
+
+#define CHECK(condition)                                               \
+    do {                                                               \
+        if (!(condition)) {                                            \
+            printf("%s:%d: %s\n", __FILE__, __LINE__, #condition);     \
+            failures++;                                                \
+        }                                                              \
+    } while (0)
+
+/**
+ * Offsets of every snapshot field, valid included.
+ */
+static const uint8_t SNAPSHOT_OFFSETS[] = {
+    offsetof(lc709204f_battery_snapshot_t, cellVoltage),
+    offsetof(lc709204f_battery_snapshot_t, rsoc),
+    offsetof(lc709204f_battery_snapshot_t, ite),
+    offsetof(lc709204f_battery_snapshot_t, timeToEmpty),
+    offsetof(lc709204f_battery_snapshot_t, timeToFull),
+    offsetof(lc709204f_battery_snapshot_t, cellTemperature),
+    offsetof(lc709204f_battery_snapshot_t, ambientTemperature),
+    offsetof(lc709204f_battery_snapshot_t, batteryStatus),
+    offsetof(lc709204f_battery_snapshot_t, cycleCount),
+    offsetof(lc709204f_battery_snapshot_t, stateOfHealth),
+    offsetof(lc709204f_battery_snapshot_t, valid),
+};
+
+#define SNAPSHOT_FIELDS (sizeof(SNAPSHOT_OFFSETS) / sizeof(SNAPSHOT_OFFSETS[0]))
+
+static uint16_t *snapshotField(lc709204f_battery_snapshot_t &snapshot, uint8_t field) {
+    return (uint16_t *)((uint8_t *) &snapshot + SNAPSHOT_OFFSETS[field]);
+}
+
+static uint16_t snapshotField(const lc709204f_battery_snapshot_t &snapshot, uint8_t field) {
+    return *(const uint16_t *)((const uint8_t *) &snapshot + SNAPSHOT_OFFSETS[field]);
+}
+
+/**
+ * Fills every field of a sample from its sequence number, a torn copy does not match.
+ */
+static void fill(lc709204f_sample_t &item, unsigned long sequence) {
+    item.timestamp = sequence;
+    for (uint8_t i = 0; i < SNAPSHOT_FIELDS; i++) {
+        *snapshotField(item.snapshot, i) = (uint16_t)(sequence * 31 + i);
+    }
+}
+
+static bool matches(const lc709204f_sample_t &item, unsigned long sequence) {
+    for (uint8_t i = 0; i < SNAPSHOT_FIELDS; i++) {
+        if (snapshotField(item.snapshot, i) != (uint16_t)(sequence * 31 + i))
+            return false;
+    }
+    return item.timestamp == sequence;
+}
+
+/**
+ * The producer retries when the ring is full: the consumer gets every item, once, in order and
+ * whole, whatever the batch size it pops with.
+ */
+static void lossless(unsigned long iterations) {
+    LC709204FRing<lc709204f_sample_t, CAPACITY> ring;
+
+    std::thread producer([&ring, iterations] {
+        lc709204f_sample_t item;
+
+        for (unsigned long i = 0; i < iterations; i++) {
+            fill(item, i);
+            while (!ring.push(item)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    lc709204f_sample_t items[CAPACITY + 1];
+    unsigned long expected = 0;
+
+    while (expected < iterations) {
+        size_t count = ring.pop(items, 1 + expected % (CAPACITY + 1));
+
+        CHECK(count <= CAPACITY);
+        for (size_t i = 0; i < count; i++, expected++) {
+            CHECK(matches(items[i], expected));
+        }
+        if (count == 0)
+            std::this_thread::yield();
+    }
+
+    producer.join();
+    CHECK(ring.empty());
+}
+
+/**
+ * The sampler reads the simulator over the fake TwoWire and never waits: the consumer gets the
+ * samples in order, complete, and the missing ones are exactly those counted as dropped.
+ */
+static void sampler(unsigned long iterations) {
+    LC709204FRing<lc709204f_sample_t, CAPACITY> ring;
+    LC709204FSampler<CAPACITY> sampler(batteryMonitor, ring, 0);
+    std::atomic<bool> done(false);
+    uint16_t rsoc = gauge.getRegister(LC709204F_REG_RSOC);
+    unsigned long pushed = 0;
+
+    // The sequence number travels in the cell voltage register, set by the sampling thread only
+    std::thread producer([&] {
+        for (unsigned long i = 0; i < iterations; i++) {
+            gauge.setRegister(LC709204F_REG_CELL_VOLTAGE, (uint16_t) i);
+            if (sampler.sample())
+                pushed++;
+            if (i % 4 == 0)
+                std::this_thread::yield();
+        }
+        done = true;
+    });
+
+    lc709204f_sample_t items[CAPACITY];
+    unsigned long popped = 0;
+    long last = -1;
+
+    for (;;) {
+        bool finished = done;
+        size_t count = ring.pop(items, CAPACITY);
+
+        for (size_t i = 0; i < count; i++) {
+            CHECK(items[i].snapshot.valid == LC709204F_FIELD_ALL);
+            CHECK((long) items[i].snapshot.cellVoltage > last);
+            CHECK(items[i].snapshot.rsoc == rsoc);
+            last = items[i].snapshot.cellVoltage;
+        }
+        popped += count;
+
+        if (count == 0) {
+            if (finished)
+                break;
+            std::this_thread::yield();
+        }
+    }
+
+    producer.join();
+    CHECK(popped == pushed);
+    CHECK(pushed + ring.getDropped() == iterations);
+    printf("sampled %lu, consumed %lu, dropped %u\n", iterations, popped, ring.getDropped());
+}
+
+int main(int argc, char **argv) {
+    unsigned long iterations = argc > 1 ? strtoul(argv[1], NULL, 10) : 50000;
+
+    // The sequence number of sampler() is a 16bit register value
+    if (iterations > 65536)
+        iterations = 65536;
+
+    Wire.attach(LC709204F_I2CADDR, &gauge);
+
+    lossless(iterations * 10);
+    sampler(iterations);
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
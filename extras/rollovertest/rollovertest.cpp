@@ -0,0 +1,160 @@
+/**
+ * @file rollovertest.cpp
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Checks that the 32-bit counters are read without tearing while they carry, against the host simulator
+ * @copyright MIT (see LICENSE.md)
+ *
+ * Build and run from the library folder:
+ *   g++ -O2 -DLC709204F_HOST_BUILD -I. extras/rollovertest/rollovertest.cpp *.cpp -o lc709204f_rollovertest
+ *   ./lc709204f_rollovertest
+ *
+ * The simulator advances the counter on every transfer (runCounter()), so the lower 16bit carries
+ * into the higher 16bit between the reads of a getter. Prints one line per failed check, the exit
+ * code is 1 if any failed.
+ */
+
+#include <stdio.h>
+#include "LC709204F.h"
+#include "LC709204FSimulator.h"
+
+#define CALLS 400 /// Getter calls per boundary, enough to cross it at every step tested
+
+static LC709204FSimulator gauge;
+static int failures = 0;
+
+#define CHECK(condition)                                               \
+    do {                                                               \
+        if (!(condition)) {                                            \
+            printf("%s:%d: %s\n", __FILE__, __LINE__, #condition);     \
+            failures++;                                                \
+        }                                                              \
+    } while (0)
+
+/**
+ * Exposes readDoubleWord() of the driver.
+ */
+class CounterProbe : public LC709204F {
+public:
+    using LC709204F::readDoubleWord;
+};
+
+static CounterProbe batteryMonitor;
+
+/**
+ * Counter register pair and the getter reading it.
+ */
+typedef struct {
+    const char *name;
+    uint8_t lower;
+    uint32_t (LC709204F::*get)(void);
+} counter_t;
+
+static const counter_t COUNTERS[] = {
+    {"TotalRunTime", LC709204F_REG_TOTAL_RUN_TIME_LOWER_16BIT, &LC709204F::getTotalRunTime},
+    {"AccumulatedTemperature", LC709204F_REG_ACCUMULATED_TEMPERATURE_LOWER_16BIT, &LC709204F::getAccumulatedTemperature},
+    {"AccumulatedRSOC", LC709204F_REG_ACCUMULATED_RSOC_LOWER_16BIT, &LC709204F::getAccumulatedRSOC},
+};
+
+static uint32_t counterValue(uint8_t lower) {
+    return (uint32_t) gauge.getRegister(lower + 1) << 16 | gauge.getRegister(lower);
+}
+
+static void setCounter(uint8_t lower, uint32_t value) {
+    gauge.setRegister(lower, (uint16_t) value);
+    gauge.setRegister(lower + 1, (uint16_t)(value >> 16));
+}
+
+/**
+ * Runs a counter across a carry into the higher 16bit: every value read must be one the counter
+ * held during the call, a torn read is off by about 0x10000.
+ *
+ * @param window rolloverWindow passed to readDoubleWord(), 0 reads without the check
+ * @return Number of torn reads
+ */
+static uint32_t crossCarry(const counter_t &counter, uint32_t boundary, uint16_t step, uint16_t window) {
+    uint32_t torn = 0;
+
+    setCounter(counter.lower, boundary - (CALLS / 2) * step);
+    gauge.runCounter(counter.lower, step);
+
+    for (int i = 0; i < CALLS; i++) {
+        uint32_t before = counterValue(counter.lower);
+        uint32_t value = 0;
+        bool ok;
+
+        if (window == LC709204F_ROLLOVER_WINDOW) {
+            value = (batteryMonitor.*counter.get)();
+            ok = batteryMonitor.getLastStatus() == LC709204F_STATUS_OK;
+        } else {
+            ok = batteryMonitor.readDoubleWord(counter.lower, counter.lower + 1, &value, window);
+        }
+
+        uint32_t after = counterValue(counter.lower);
+
+        CHECK(ok);
+        if (value < before || value > after)
+            torn++;
+    }
+
+    gauge.runCounter(counter.lower, 0);
+    CHECK(counterValue(counter.lower) > boundary);
+    return torn;
+}
+
+/**
+ * The getters never tear, at steps from 1 up to just below the rollover window.
+ */
+static void getters(void) {
+    static const uint16_t STEPS[] = {1, 0x10, LC709204F_ROLLOVER_WINDOW - 1};
+    static const uint32_t BOUNDARIES[] = {0x00010000, 0x00A50000};
+
+    for (const counter_t &counter : COUNTERS) {
+        for (uint16_t step : STEPS) {
+            for (uint32_t boundary : BOUNDARIES) {
+                uint32_t torn = crossCarry(counter, boundary, step, LC709204F_ROLLOVER_WINDOW);
+
+                if (torn) {
+                    printf("%s: %u torn reads across 0x%08X at step 0x%X\n", counter.name, torn, boundary, step);
+                    failures++;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Without the second read of the higher 16bit, the same run does tear: the test can tell.
+ */
+static void withoutCheck(void) {
+    CHECK(crossCarry(COUNTERS[0], 0x00010000, 0x10, 0) > 0);
+}
+
+/**
+ * Far from a carry the higher 16bit is read once, right after one it is read again.
+ */
+static void transfers(void) {
+    uint8_t lower = LC709204F_REG_TOTAL_RUN_TIME_LOWER_16BIT;
+    uint32_t issued;
+
+    setCounter(lower, 0x00018000);
+    issued = batteryMonitor.getIssuedReads();
+    CHECK(batteryMonitor.getTotalRunTime() == 0x00018000);
+    CHECK(batteryMonitor.getIssuedReads() - issued == 2);
+
+    setCounter(lower, 0x00020010);
+    issued = batteryMonitor.getIssuedReads();
+    CHECK(batteryMonitor.getTotalRunTime() == 0x00020010);
+    CHECK(batteryMonitor.getIssuedReads() - issued == 3);
+}
+
+int main(void) {
+    Wire.attach(LC709204F_I2CADDR, &gauge);
+
+    getters();
+    withoutCheck();
+    transfers();
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
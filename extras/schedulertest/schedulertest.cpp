@@ -0,0 +1,154 @@
+/**
+ * @file schedulertest.cpp
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Checks the LC709204FScheduler intervals and batches against the host simulator
+ * @copyright MIT (see LICENSE.md)
+ *
+ * Build and run from the library folder:
+ *   g++ -O2 -DLC709204F_HOST_BUILD -I. extras/schedulertest/schedulertest.cpp *.cpp -o lc709204f_schedulertest
+ *   ./lc709204f_schedulertest
+ *
+ * Runs on millis() with intervals of a few ms, under a second in all. Prints one line per failed
+ * check, the exit code is 1 if any failed.
+ */
+
+#include <stdio.h>
+#include "LC709204F.h"
+#include "LC709204FScheduler.h"
+#include "LC709204FSimulator.h"
+
+#define TIMEOUT 1000 /// Longest wait for a register to become due, ms
+
+static LC709204FSimulator gauge;
+static LC709204F batteryMonitor;
+static int failures = 0;
+
+#define CHECK(condition)                                               \
+    do {                                                               \
+        if (!(condition)) {                                            \
+            printf("%s:%d: %s\n", __FILE__, __LINE__, #condition);     \
+            failures++;                                                \
+        }                                                              \
+    } while (0)
+
+/**
+ * Ticks until a register is read.
+ *
+ * @return False if none became due within TIMEOUT
+ */
+static bool nextRead(LC709204FScheduler &scheduler) {
+    unsigned long start = millis();
+
+    while (scheduler.tick() == 0) {
+        if (millis() - start > TIMEOUT)
+            return false;
+        delay(1);
+    }
+    return true;
+}
+
+/**
+ * Unchanged reads grow the interval by half plus 1ms up to the maximum, changed reads halve it
+ * down to the minimum.
+ */
+static void intervals(void) {
+    static const unsigned long GROWTH[] = {1, 2, 4, 7, 11, 17, 26, 40, 61, 80, 80};
+    static const unsigned long HALVING[] = {40, 20, 10, 5, 2, 1, 1};
+    LC709204FScheduler scheduler(batteryMonitor);
+    uint16_t value = 0;
+
+    gauge.setRegister(LC709204F_REG_RSOC, 50);
+    CHECK(scheduler.add(LC709204F_REG_RSOC, 1, 80) >= 0);
+    CHECK(!scheduler.getValue(LC709204F_REG_RSOC, &value));
+
+    // The first read has nothing to compare with and keeps the minimum
+    for (unsigned long interval : GROWTH) {
+        CHECK(nextRead(scheduler));
+        CHECK(scheduler.getInterval(LC709204F_REG_RSOC) == interval);
+    }
+    CHECK(scheduler.getValue(LC709204F_REG_RSOC, &value) && value == 50);
+
+    for (unsigned long interval : HALVING) {
+        gauge.setRegister(LC709204F_REG_RSOC, ++value);
+        CHECK(nextRead(scheduler));
+        CHECK(scheduler.getInterval(LC709204F_REG_RSOC) == interval);
+    }
+
+    // A failed read is retried without changing the interval
+    gauge.injectNack(1);
+    CHECK(nextRead(scheduler));
+    CHECK(scheduler.getInterval(LC709204F_REG_RSOC) == 1);
+    CHECK(nextRead(scheduler));
+    CHECK(scheduler.getInterval(LC709204F_REG_RSOC) == 2);
+}
+
+/**
+ * A minimum of 0 is 1ms, so halving never reaches a zero interval, and a maximum below the
+ * minimum is the minimum.
+ */
+static void limits(void) {
+    LC709204FScheduler scheduler(batteryMonitor);
+    uint16_t value = gauge.getRegister(LC709204F_REG_ITE);
+
+    scheduler.add(LC709204F_REG_ITE, 0, 4);
+    CHECK(scheduler.getInterval(LC709204F_REG_ITE) == 1);
+
+    for (int i = 0; i < 4; i++) {
+        gauge.setRegister(LC709204F_REG_ITE, ++value);
+        CHECK(nextRead(scheduler));
+        CHECK(scheduler.getInterval(LC709204F_REG_ITE) == 1);
+    }
+
+    scheduler.add(LC709204F_REG_CELL_VOLTAGE, 20, 5);
+    for (int i = 0; i < 3; i++) {
+        CHECK(nextRead(scheduler));
+    }
+    CHECK(scheduler.getInterval(LC709204F_REG_CELL_VOLTAGE) == 20);
+
+    CHECK(scheduler.add(LC709204F_REG_ITE, 1, 1) < 0);
+    CHECK(scheduler.remove(LC709204F_REG_ITE));
+    CHECK(scheduler.getInterval(LC709204F_REG_ITE) == 0);
+}
+
+/**
+ * A tick reads the due registers in one batch of at most getReadsPerTick() reads, most overdue
+ * first; the others stay due for the next tick.
+ */
+static void budget(void) {
+    LC709204FScheduler scheduler(batteryMonitor, 3 * LC709204F_READ_BITS * 10, 100000);
+    uint16_t value;
+
+    CHECK(scheduler.getReadsPerTick() == 3);
+
+    scheduler.add(LC709204F_REG_CYCLE_COUNT, 60000, 60000);
+    delay(5);
+    scheduler.addDefaults();
+
+    uint32_t issued = batteryMonitor.getIssuedReads();
+    CHECK(scheduler.tick() == 3);
+    CHECK(batteryMonitor.getIssuedReads() - issued == 3);
+    CHECK(scheduler.getValue(LC709204F_REG_CYCLE_COUNT, &value));
+
+    // The defaults hold CycleCount already: 10 registers in all
+    CHECK(scheduler.tick() == 3);
+    CHECK(scheduler.tick() == 3);
+    CHECK(scheduler.tick() == 1);
+    CHECK(scheduler.tick() == 0);
+    CHECK(batteryMonitor.getIssuedReads() - issued == 10);
+
+    // Less than one read of budget still reads one
+    scheduler.setBudget(1);
+    CHECK(scheduler.getReadsPerTick() == 1);
+}
+
+int main(void) {
+    Wire.attach(LC709204F_I2CADDR, &gauge);
+
+    intervals();
+    limits();
+    budget();
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
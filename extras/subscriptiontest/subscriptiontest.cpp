@@ -0,0 +1,167 @@
+/**
+ * @file subscriptiontest.cpp
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Checks the LC709204FSubscriptions deadbands and batching against the host simulator
+ * @copyright MIT (see LICENSE.md)
+ *
+ * Build and run from the library folder:
+ *   g++ -O2 -DLC709204F_HOST_BUILD -I. extras/subscriptiontest/subscriptiontest.cpp *.cpp -o lc709204f_subscriptiontest
+ *   ./lc709204f_subscriptiontest
+ *
+ * Prints one line per failed check, the exit code is 1 if any failed.
+ */
+
+#include <stdio.h>
+#include "LC709204F.h"
+#include "LC709204FSimulator.h"
+#include "LC709204FSubscriptions.h"
+
+static LC709204FSimulator gauge;
+static LC709204F batteryMonitor;
+static int failures = 0;
+
+#define CHECK(condition)                                               \
+    do {                                                               \
+        if (!(condition)) {                                            \
+            printf("%s:%d: %s\n", __FILE__, __LINE__, #condition);     \
+            failures++;                                                \
+        }                                                              \
+    } while (0)
+
+/**
+ * Last report of a subscription
+ */
+typedef struct {
+    int calls;
+    uint16_t value;
+    uint16_t previous;
+} report_t;
+
+static void onChange(int8_t handle, uint16_t value, uint16_t previous, void *context) {
+    report_t *report = (report_t *) context;
+
+    report->calls++;
+    report->value = value;
+    report->previous = previous;
+}
+
+/**
+ * Updates after setting the register, and tells whether the subscription was called.
+ */
+static bool reported(LC709204FSubscriptions &subscriptions, report_t &report, uint8_t command, uint16_t value) {
+    int calls = report.calls;
+
+    gauge.setRegister(command, value);
+    subscriptions.update();
+    return report.calls == calls + 1;
+}
+
+/**
+ * The first sample is reported with previous equal to value, then a change of exactly the
+ * threshold is reported, one less is not, in both directions.
+ */
+static void deadband(void) {
+    LC709204FSubscriptions subscriptions(batteryMonitor);
+    report_t report = {0, 0, 0};
+
+    gauge.setRegister(LC709204F_REG_CELL_VOLTAGE, 3700);
+    CHECK(subscriptions.subscribe(LC709204F_REG_CELL_VOLTAGE, 20, onChange, &report) >= 0);
+
+    CHECK(subscriptions.update() == 1);
+    CHECK(report.calls == 1 && report.value == 3700 && report.previous == 3700);
+
+    // Unchanged, then one below the threshold
+    CHECK(!reported(subscriptions, report, LC709204F_REG_CELL_VOLTAGE, 3700));
+    CHECK(!reported(subscriptions, report, LC709204F_REG_CELL_VOLTAGE, 3719));
+
+    // Exactly the threshold, from the last reported value
+    CHECK(reported(subscriptions, report, LC709204F_REG_CELL_VOLTAGE, 3720));
+    CHECK(report.value == 3720 && report.previous == 3700);
+
+    CHECK(!reported(subscriptions, report, LC709204F_REG_CELL_VOLTAGE, 3701));
+    CHECK(reported(subscriptions, report, LC709204F_REG_CELL_VOLTAGE, 3700));
+    CHECK(report.value == 3700 && report.previous == 3720);
+
+    // A slow drift is reported once it adds up to the threshold
+    CHECK(!reported(subscriptions, report, LC709204F_REG_CELL_VOLTAGE, 3710));
+    CHECK(reported(subscriptions, report, LC709204F_REG_CELL_VOLTAGE, 3680));
+    CHECK(report.previous == 3700);
+
+    // Both ends of the 16-bit range
+    CHECK(reported(subscriptions, report, LC709204F_REG_CELL_VOLTAGE, 0xFFFF));
+    CHECK(reported(subscriptions, report, LC709204F_REG_CELL_VOLTAGE, 0));
+}
+
+/**
+ * A threshold of 0 or 1 reports every change, and nothing while the value stays.
+ */
+static void everyChange(void) {
+    LC709204FSubscriptions subscriptions(batteryMonitor);
+    report_t report = {0, 0, 0};
+
+    gauge.setRegister(LC709204F_REG_RSOC, 50);
+    subscriptions.subscribe(LC709204F_REG_RSOC, 0, onChange, &report);
+    subscriptions.update();
+
+    CHECK(!reported(subscriptions, report, LC709204F_REG_RSOC, 50));
+    CHECK(reported(subscriptions, report, LC709204F_REG_RSOC, 51));
+    CHECK(reported(subscriptions, report, LC709204F_REG_RSOC, 50));
+}
+
+/**
+ * Every subscribed register is read once per update, in one execute() call, whatever the
+ * number of subscriptions watching it. A failed read reports nothing, the next update does.
+ */
+static void batching(void) {
+    LC709204FSubscriptions subscriptions(batteryMonitor);
+    report_t voltage = {0, 0, 0};
+    report_t voltageCoarse = {0, 0, 0};
+    report_t rsoc = {0, 0, 0};
+    report_t ite = {0, 0, 0};
+
+    gauge.setRegister(LC709204F_REG_CELL_VOLTAGE, 3700);
+    subscriptions.subscribe(LC709204F_REG_CELL_VOLTAGE, 1, onChange, &voltage);
+    subscriptions.subscribe(LC709204F_REG_RSOC, 1, onChange, &rsoc);
+    subscriptions.subscribe(LC709204F_REG_CELL_VOLTAGE, 100, onChange, &voltageCoarse);
+    subscriptions.subscribe(LC709204F_REG_ITE, 1, onChange, &ite);
+
+    uint32_t issued = batteryMonitor.getIssuedReads();
+
+    CHECK(subscriptions.update() == 4);
+    CHECK(subscriptions.getReads() == 3);
+    CHECK(batteryMonitor.getIssuedReads() - issued == 3);
+
+    // Only the fine subscription of the shared register moves
+    gauge.setRegister(LC709204F_REG_CELL_VOLTAGE, 3710);
+    CHECK(subscriptions.update() == 1);
+    CHECK(voltage.calls == 2 && voltage.value == 3710 && voltageCoarse.calls == 1);
+
+    // The first item of the batch fails, the others are still reported
+    gauge.setRegister(LC709204F_REG_CELL_VOLTAGE, 3600);
+    gauge.setRegister(LC709204F_REG_RSOC, gauge.getRegister(LC709204F_REG_RSOC) + 1);
+    gauge.injectNack(1);
+    CHECK(subscriptions.update() == 1);
+    CHECK(voltage.calls == 2 && voltageCoarse.calls == 1 && rsoc.calls == 2);
+
+    CHECK(subscriptions.update() == 2);
+    CHECK(voltage.value == 3600 && voltage.previous == 3710);
+    CHECK(voltageCoarse.value == 3600 && voltageCoarse.previous == 3700);
+
+    // Nothing subscribed, nothing read
+    LC709204FSubscriptions empty(batteryMonitor);
+    issued = batteryMonitor.getIssuedReads();
+    CHECK(empty.update() == 0 && empty.getReads() == 0);
+    CHECK(batteryMonitor.getIssuedReads() == issued);
+}
+
+int main(void) {
+    Wire.attach(LC709204F_I2CADDR, &gauge);
+
+    deadband();
+    everyChange();
+    batching();
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
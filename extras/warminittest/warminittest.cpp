@@ -0,0 +1,140 @@
+/**
+ * @file warminittest.cpp
+ * @author Razvan Mocanu <razvan@mocanu.biz>
+ * @version 1.0.0
+ * @details Checks LC709204F::warmInit() cold and warm starts against the host simulator
+ * @copyright MIT (see LICENSE.md)
+ *
+ * Build and run from the library folder:
+ *   g++ -O2 -DLC709204F_HOST_BUILD -I. extras/warminittest/warminittest.cpp *.cpp -o lc709204f_warminittest
+ *   ./lc709204f_warminittest
+ *
+ * Every start uses a new LC709204F, like an MCU reboot: nothing is served from its shadow
+ * register file. Prints one line per failed check, the exit code is 1 if any failed.
+ */
+
+#include <stdio.h>
+#include "LC709204F.h"
+#include "LC709204FSimulator.h"
+
+#define APA LC709204F_APA_2000MAH                            /// Configured APA
+#define PROFILE LC709204F_BATTERY_PROFILE_ICR18650_26H_SAMSUNG /// Configured battery profile
+
+static LC709204FSimulator gauge;
+static int failures = 0;
+
+#define CHECK(condition)                                               \
+    do {                                                               \
+        if (!(condition)) {                                            \
+            printf("%s:%d: %s\n", __FILE__, __LINE__, #condition);     \
+            failures++;                                                \
+        }                                                              \
+    } while (0)
+
+/**
+ * Starts with a new driver instance.
+ *
+ * @param warm Set to the warm flag of warmInit()
+ * @param writes Set to the number of writes issued
+ * @return warmInit() result
+ */
+static bool start(bool &warm, uint32_t &writes) {
+    LC709204F batteryMonitor;
+
+    warm = true;
+    bool success = batteryMonitor.warmInit(APA, PROFILE, &warm);
+
+    writes = batteryMonitor.getIssuedWrites();
+    return success;
+}
+
+/**
+ * The configuration registers hold what init() writes.
+ */
+static bool initialized(void) {
+    return gauge.getRegister(LC709204F_REG_APA) == APA &&
+           gauge.getRegister(LC709204F_REG_CHANGE_OF_THE_PARAMETER) == PROFILE &&
+           gauge.getRegister(LC709204F_REG_IC_POWER_MODE) == LC709204F_POWER_MODE_OPERATE &&
+           !(gauge.getRegister(LC709204F_REG_BATTERY_STATUS) & LC709204F_BATTERY_STATUS_INITIALIZED);
+}
+
+/**
+ * After a power on reset the full init() runs, the next starts write nothing.
+ */
+static void coldThenWarm(void) {
+    bool warm;
+    uint32_t writes;
+
+    gauge.powerOnReset();
+    CHECK(start(warm, writes));
+    CHECK(!warm && writes == 4);
+    CHECK(initialized());
+
+    for (int i = 0; i < 3; i++) {
+        CHECK(start(warm, writes));
+        CHECK(warm && writes == 0);
+    }
+    CHECK(initialized());
+}
+
+/**
+ * Any fingerprint register differing from the configuration, or a failed read, runs the full
+ * init() again.
+ */
+static void mismatches(void) {
+    static const struct {
+        uint8_t command;
+        uint16_t value;
+    } CHANGES[] = {
+        {LC709204F_REG_BATTERY_STATUS, LC709204F_BATTERY_STATUS_INITIALIZED},
+        {LC709204F_REG_APA, LC709204F_APA_1000MAH},
+        {LC709204F_REG_CHANGE_OF_THE_PARAMETER, LC709204F_BATTERY_PROFILE_3_8_V},
+        {LC709204F_REG_IC_POWER_MODE, LC709204F_POWER_MODE_SLEEP},
+    };
+    bool warm;
+    uint32_t writes;
+
+    for (const auto &change : CHANGES) {
+        gauge.setRegister(change.command, change.value);
+        CHECK(start(warm, writes));
+        CHECK(!warm && writes == 4);
+        CHECK(initialized());
+    }
+
+    // The BatteryStatus read fails: nothing is known about the gauge
+    gauge.injectCrcError(1);
+    CHECK(start(warm, writes));
+    CHECK(!warm && writes == 4);
+
+    CHECK(start(warm, writes));
+    CHECK(warm && writes == 0);
+}
+
+/**
+ * A cold start whose writes fail reports it, the next start initializes.
+ */
+static void failedInit(void) {
+    bool warm;
+    uint32_t writes;
+
+    // The BatteryStatus read, then the first write of init()
+    gauge.powerOnReset();
+    gauge.injectNack(2);
+    CHECK(!start(warm, writes));
+    CHECK(!warm && writes == 1);
+
+    CHECK(start(warm, writes));
+    CHECK(!warm && writes == 4);
+    CHECK(initialized());
+}
+
+int main(void) {
+    Wire.attach(LC709204F_I2CADDR, &gauge);
+
+    coldThenWarm();
+    mismatches();
+    failedInit();
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}